@@ -32,13 +32,17 @@ int ENABLE_LIFTING = 0;
 int MIN_N_ROWS = 2;
 int MAX_N_ROWS = 2;
 
-int SHOULD_DUMP_CUTS = 0;
-int DUMP_CUT_N = 0;
-
 int GENERATE_MIR = 0;
 int GENERATE_INFINITY = 0;
 int KEEP_INTEGRALITY = 0;
 int N_ROUNDS = 1;
+int N_THREADS = 1;
+int CUT_POOL_SIZE = 0;
+int CUT_BATCH_SIZE = 1;
+int CUT_SELECTION = CUT_SELECTION_VIOLATION;
+int TABLEAU_ENGINE = TABLEAU_ENGINE_CPLEX;
+int LFREE_2D_ALGORITHM = LFREE_2D_ALGORITHM_FAST;
+int LFREE_CACHE_SIZE = 10000;
 
 char BASIS_FILENAME[1000] = {0};
 char PROBLEM_FILENAME[1000] = {0};
@@ -56,6 +60,13 @@ double BOOST_FACTOR = 0.01;
 
 #define OPTION_WRITE_BASIS 1000
 #define OPTION_WRITE_SOLUTION 1001
+#define OPTION_THREADS 1002
+#define OPTION_POOL 1003
+#define OPTION_BATCH 1004
+#define OPTION_SELECT 1005
+#define OPTION_TABLEAU 1006
+#define OPTION_LFREE_2D 1007
+#define OPTION_CACHE 1008
 
 static const struct option options_tab[] =
 {
@@ -74,6 +85,13 @@ static const struct option options_tab[] =
     {"boost", required_argument, 0, 't'},
     {"lift", no_argument, 0, 'i'},
     {"rows", required_argument, 0, 'a'},
+    {"threads", required_argument, 0, OPTION_THREADS},
+    {"pool", required_argument, 0, OPTION_POOL},
+    {"batch", required_argument, 0, OPTION_BATCH},
+    {"select", required_argument, 0, OPTION_SELECT},
+    {"tableau", required_argument, 0, OPTION_TABLEAU},
+    {"lfree2d", required_argument, 0, OPTION_LFREE_2D},
+    {"cache", required_argument, 0, OPTION_CACHE},
     {0, 0, 0, 0}
 };
 
@@ -107,6 +125,20 @@ static void print_usage(char **argv)
     printf("%4s %-20s %s\n", "", "--lift", "enable trivial lifting");
     printf("%4s %-20s %s\n", "", "--rows=N",
             "generate multi-row cuts from up to N rows");
+    printf("%4s %-20s %s\n", "", "--threads=N",
+            "number of threads used to generate multi-row cuts");
+    printf("%4s %-20s %s\n", "", "--pool=N",
+            "number of cuts collected before reoptimizing (default: batch)");
+    printf("%4s %-20s %s\n", "", "--batch=N",
+            "maximum number of cuts added per reoptimization");
+    printf("%4s %-20s %s\n", "", "--select=POLICY",
+            "cut selection policy (violation, dynamism)");
+    printf("%4s %-20s %s\n", "", "--tableau=ENGINE",
+            "engine used to compute tableau rows (cplex, lu)");
+    printf("%4s %-20s %s\n", "", "--lfree2d=ALG",
+            "algorithm for two-row lattice-free sets (fast, nd, validate)");
+    printf("%4s %-20s %s\n", "", "--cache=N",
+            "number of lattice-free sets kept in cache (default: 10000)");
 }
 
 static int parse_args(int argc,
@@ -162,6 +194,66 @@ static int parse_args(int argc,
             strcpy(OUTPUT_SOLUTION_FILENAME, optarg);
             break;
 
+        case OPTION_THREADS:
+            N_THREADS = atoi(optarg);
+            break;
+
+        case OPTION_POOL:
+            CUT_POOL_SIZE = atoi(optarg);
+            break;
+
+        case OPTION_BATCH:
+            CUT_BATCH_SIZE = atoi(optarg);
+            break;
+
+        case OPTION_SELECT:
+            if (strcmp(optarg, "violation") == 0)
+                CUT_SELECTION = CUT_SELECTION_VIOLATION;
+            else if (strcmp(optarg, "dynamism") == 0)
+                CUT_SELECTION = CUT_SELECTION_DYNAMISM;
+            else
+            {
+                fprintf(stderr, "%s: invalid selection policy '%s'\n",
+                        argv[0], optarg);
+                rval = 1;
+                goto CLEANUP;
+            }
+            break;
+
+        case OPTION_TABLEAU:
+            if (strcmp(optarg, "cplex") == 0)
+                TABLEAU_ENGINE = TABLEAU_ENGINE_CPLEX;
+            else if (strcmp(optarg, "lu") == 0)
+                TABLEAU_ENGINE = TABLEAU_ENGINE_LU;
+            else
+            {
+                fprintf(stderr, "%s: invalid tableau engine '%s'\n",
+                        argv[0], optarg);
+                rval = 1;
+                goto CLEANUP;
+            }
+            break;
+
+        case OPTION_LFREE_2D:
+            if (strcmp(optarg, "fast") == 0)
+                LFREE_2D_ALGORITHM = LFREE_2D_ALGORITHM_FAST;
+            else if (strcmp(optarg, "nd") == 0)
+                LFREE_2D_ALGORITHM = LFREE_2D_ALGORITHM_ND;
+            else if (strcmp(optarg, "validate") == 0)
+                LFREE_2D_ALGORITHM = LFREE_2D_ALGORITHM_VALIDATE;
+            else
+            {
+                fprintf(stderr, "%s: invalid lattice-free set algorithm '%s'\n",
+                        argv[0], optarg);
+                rval = 1;
+                goto CLEANUP;
+            }
+            break;
+
+        case OPTION_CACHE:
+            LFREE_CACHE_SIZE = atoi(optarg);
+            break;
+
         case OPTION_WRITE_BASIS:
             strcpy(OUTPUT_BASIS_FILENAME, optarg);
             break;
@@ -220,6 +312,33 @@ static int parse_args(int argc,
         rval = 1;
     }
 
+    if (N_THREADS < 1)
+    {
+        fprintf(stderr, "Invalid number of threads.\n");
+        rval = 1;
+    }
+
+    if (CUT_BATCH_SIZE < 1)
+    {
+        fprintf(stderr, "Invalid batch size.\n");
+        rval = 1;
+    }
+
+    if (LFREE_CACHE_SIZE < 0)
+    {
+        fprintf(stderr, "Invalid cache size.\n");
+        rval = 1;
+    }
+
+    if (CUT_POOL_SIZE == 0)
+        CUT_POOL_SIZE = CUT_BATCH_SIZE;
+
+    if (CUT_POOL_SIZE < CUT_BATCH_SIZE)
+    {
+        fprintf(stderr, "Pool size cannot be smaller than batch size.\n");
+        rval = 1;
+    }
+
 CLEANUP:
     if (rval)
         fprintf(stderr, "Try '%s --help' for more information.\n", argv[0]);
@@ -262,6 +381,10 @@ int main(int argc,
     struct LP lp;
     char *column_types = 0;
 
+    struct InfinityContext *contexts = 0;
+    void **context_ptrs = 0;
+    struct LFreeCache lfree_cache = {0};
+
     rval = parse_args(argc, argv);
     if (rval) return 1;
 
@@ -280,6 +403,26 @@ int main(int argc,
     STATS_set_input_filename(PROBLEM_FILENAME);
     progress_title(PROBLEM_FILENAME);
 
+    contexts = (struct InfinityContext *) malloc(
+            N_THREADS * sizeof(struct InfinityContext));
+    context_ptrs = (void **) malloc(N_THREADS * sizeof(void *));
+    abort_if(!contexts, "could not allocate contexts");
+    abort_if(!context_ptrs, "could not allocate context_ptrs");
+
+    if (LFREE_CACHE_SIZE > 0)
+    {
+        rval = LFREE_CACHE_init(&lfree_cache, LFREE_CACHE_SIZE);
+        abort_if(rval, "LFREE_CACHE_init failed");
+    }
+
+    for (int t = 0; t < N_THREADS; t++)
+    {
+        INFINITY_init_context(&contexts[t], t);
+        if_debug_level contexts[t].should_dump_cuts = 1;
+        if (LFREE_CACHE_SIZE > 0) contexts[t].cache = &lfree_cache;
+        context_ptrs[t] = &contexts[t];
+    }
+
     rval = LP_open(&lp);
     abort_if(rval, "LP_open failed");
 
@@ -415,7 +558,8 @@ int main(int argc,
                 log_info("Adding infinity cuts (%d rows)...\n", k);
 
                 rval = CG_add_multirow_cuts(cg, k,
-                        (MultiRowGeneratorCallback) INFINITY_generate_cut);
+                        (MultiRowGeneratorCallback) INFINITY_generate_cut,
+                        context_ptrs);
                 abort_if(rval, "CG_add_multirow_cuts failed");
             }
 
@@ -435,6 +579,19 @@ int main(int argc,
         CG_free(cg);
     }
 
+    if (GENERATE_INFINITY)
+    {
+        struct InfinityStats total = {0};
+
+        for (int t = 0; t < N_THREADS; t++)
+            INFINITY_ND_merge_stats(&total, &contexts[t].stats);
+
+        INFINITY_ND_print_stats(&total);
+
+        if (LFREE_CACHE_SIZE > 0)
+            log_info("    %d lattice-free sets cached, %ld evicted\n",
+                    lfree_cache.n_entries, lfree_cache.evictions);
+    }
 
     if(BOOST_VAR > 0)
     {
@@ -460,6 +617,10 @@ CLEANUP:
     if (LOG_FILE) fclose(LOG_FILE);
     if (x) free(x);
     if (column_types) free(column_types);
+    if (contexts) free(contexts);
+    if (context_ptrs) free(context_ptrs);
+    LFREE_CACHE_free(&lfree_cache);
+    LP_pool_free();
     LP_free(&lp);
 
     return rval;
@@ -16,6 +16,32 @@
 #ifndef MULTIROW_INFINITY_ND_H
 #define MULTIROW_INFINITY_ND_H
 
+/**
+ * Number of LPs solved by INFINITY_ND_generate_lfree, and time spent on them.
+ * Each thread should accumulate into its own copy, since the counters are not
+ * protected by locks.
+ */
+struct InfinityStats
+{
+    long lp_count;
+    double lp_time;
+
+    long epsilon_lp_count;
+    double epsilon_lp_time;
+
+    long tight_lp_count;
+    double tight_lp_time;
+
+    long violated_lp_count;
+    double violated_lp_time;
+
+    long sfree_mip_count;
+    double sfree_mip_time;
+
+    long scale_ahull_lp_count;
+    double scale_ahull_lp_time;
+};
+
 int INFINITY_create_psi_lp(const struct ConvLFreeSet *lfree, struct LP *lp);
 
 int INFINITY_psi(const int nrows,
@@ -27,10 +53,32 @@ int INFINITY_psi(const int nrows,
 int INFINITY_pi(const int nrows,
                 const double *q,
                 const double q_scale,
+                const struct ConvLFreeSet *lfree,
                 struct LP *lp,
                 double *value);
 
+int INFINITY_psi_halfspaces(const int nrows,
+                            const double *q,
+                            const double q_scale,
+                            const struct ConvLFreeSet *lfree,
+                            double *value);
+
+int INFINITY_pi_halfspaces(const int nrows,
+                           const double *q,
+                           const double q_scale,
+                           const struct ConvLFreeSet *lfree,
+                           double *value);
+
 int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
-                               struct ConvLFreeSet *lfree);
+                               struct ConvLFreeSet *lfree,
+                               struct InfinityStats *stats);
+
+/**
+ * Adds the counters in stats to the counters in total.
+ */
+void INFINITY_ND_merge_stats(struct InfinityStats *total,
+                             const struct InfinityStats *stats);
+
+void INFINITY_ND_print_stats(const struct InfinityStats *stats);
 
 #endif //MULTIROW_INFINITY_ND_H
@@ -19,6 +19,31 @@
 #include <multirow/cg.h>
 #include <multirow/lp.h>
 
-int INFINITY_generate_cut(const struct Tableau *tableau, struct Row *cut);
+#include <infinity/infinity-nd.h>
+#include <infinity/lfree-cache.h>
+
+/**
+ * State of one cut generator. Contexts are not shared, so that each thread
+ * can call INFINITY_generate_cut concurrently with its own context.
+ */
+struct InfinityContext
+{
+    int id;
+
+    int should_dump_cuts;
+    int dump_cut_n;
+
+    struct InfinityStats stats;
+
+    /** Cache of lattice-free sets, possibly shared with other contexts, or
+     * null if caching is disabled. */
+    struct LFreeCache *cache;
+};
+
+void INFINITY_init_context(struct InfinityContext *ctx, int id);
+
+int INFINITY_generate_cut(const struct Tableau *tableau,
+                          struct InfinityContext *ctx,
+                          struct Row *cut);
 
 #endif //MULTIROW_INFINITY_H
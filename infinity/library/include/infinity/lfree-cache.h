@@ -0,0 +1,95 @@
+/* Copyright (c) 2015 Alinson Xavier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MULTIROW_LFREE_CACHE_H
+#define MULTIROW_LFREE_CACHE_H
+
+#include <multirow/cg.h>
+
+/**
+ * Key of a multi-row model: its dimension, f and its rays, in the order they
+ * appear in the model. Models with the same rays in a different order have
+ * different keys, since the lattice-free set found for them may differ.
+ */
+struct LFreeCacheKey
+{
+    int nrows;
+    int nrays;
+    int length;
+    double *values;
+    unsigned long hash;
+};
+
+struct LFreeCacheEntry
+{
+    struct LFreeCacheKey key;
+    double *beta;
+
+    int bucket_next;
+    int lru_prev;
+    int lru_next;
+};
+
+/**
+ * Bounded cache of lattice-free sets, indexed by the models they were
+ * computed from. When the cache is full, the least recently used set is
+ * evicted. The cache may be shared by several threads.
+ */
+struct LFreeCache
+{
+    int capacity;
+    int n_entries;
+    struct LFreeCacheEntry *entries;
+
+    int n_buckets;
+    int *buckets;
+
+    int lru_first;
+    int lru_last;
+
+    long evictions;
+};
+
+int LFREE_CACHE_init(struct LFreeCache *cache, int capacity);
+
+void LFREE_CACHE_free(struct LFreeCache *cache);
+
+/**
+ * Computes the key of the given model.
+ */
+int LFREE_CACHE_init_key(const struct MultiRowModel *model,
+                         struct LFreeCacheKey *key);
+
+void LFREE_CACHE_free_key(struct LFreeCacheKey *key);
+
+/**
+ * Looks for the lattice-free set of a model with the given key. If found,
+ * its beta vector is written to beta, in the order of the rays of the
+ * model the key was computed from.
+ */
+int LFREE_CACHE_lookup(struct LFreeCache *cache,
+                       const struct LFreeCacheKey *key,
+                       double *beta,
+                       int *found);
+
+/**
+ * Stores the beta vector of the lattice-free set of a model with the given
+ * key. Does nothing if the key is already in the cache.
+ */
+int LFREE_CACHE_insert(struct LFreeCache *cache,
+                       const struct LFreeCacheKey *key,
+                       const double *beta);
+
+#endif //MULTIROW_LFREE_CACHE_H
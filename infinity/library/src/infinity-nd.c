@@ -24,24 +24,6 @@
 #include <infinity/infinity-nd.h>
 #include <multirow/linalg.h>
 
-static long lp_count = 0;
-static double lp_time = 0;
-
-static long epsilon_lp_count = 0;
-static double epsilon_lp_time = 0;
-
-static long tight_lp_count = 0;
-static double tight_lp_time = 0;
-
-static long violated_lp_count = 0;
-static double violated_lp_time = 0;
-
-static long sfree_mip_count = 0;
-static double sfree_mip_time = 0;
-
-static long scale_ahull_lp_count = 0;
-static double scale_ahull_lp_time = 0;
-
 static int cone_bound_find_lambda(const struct RayList *rays,
                                   const double *f,
                                   const double *x,
@@ -158,14 +140,20 @@ CLEANUP:
     return rval;
 }
 
+/*
+ * Builds the LP used by cone_bound. Each ray r in Rx has two lambda columns:
+ * one used while r is in T, at column map[r] + 1, and one used while r is not
+ * in T, at column map[r]. The column of the other case is fixed to zero, so
+ * that moving a ray into T only requires bound changes. Initially, T is empty.
+ */
 static int create_find_epsilon_lp(int nrows,
                                   int nrays,
                                   const double *f,
                                   const double *rays,
-                                  const int *t,
                                   const int *rx,
                                   const double *x,
                                   const double *beta,
+                                  int *map,
                                   struct LP *lp)
 {
     int rval = 0;
@@ -174,17 +162,14 @@ static int create_find_epsilon_lp(int nrows,
     char sense;
 
     int nz = 0;
-    int *map = 0;
     int rmatbeg = 0;
     int *rmatind = 0;
     double *rmatval = 0;
     int rx_count = 0;
+    int lambda_x;
 
-    map = (int *) malloc(nrays * sizeof(int));
-    abort_if(!map, "could not allocate map");
-
-    rmatind = (int *) malloc((nrays + 1 + nrows) * sizeof(int));
-    rmatval = (double *) malloc((nrays + 1 + nrows) * sizeof(double));
+    rmatind = (int *) malloc((2 * nrays + 1 + nrows) * sizeof(int));
+    rmatval = (double *) malloc((2 * nrays + 1 + nrows) * sizeof(double));
     abort_if(!rmatind, "could not allocate rmatind");
     abort_if(!rmatval, "could not allocate rmatval");
 
@@ -192,28 +177,27 @@ static int create_find_epsilon_lp(int nrows,
     abort_if(rval, "LP_create failed");
 
     // create lambda variables
-    for(int i = 0; i < nrays + 1; i++)
+    for(int i = 0; i < nrays; i++)
     {
-        if(i < nrays && !rx[i]) continue;
-
-        double pi = 0.0;
-        double lb = -MILP_INFINITY;
+        if(!rx[i]) continue;
 
-        if(i < nrays && !t[i])
-        {
-            pi = 1.0;
-            lb = 0.0;
-        }
+        // ray not in T
+        rval = LP_new_col(lp, 1.0, 0.0, MILP_INFINITY, 'C');
+        abort_if(rval, "LP_new_col failed");
 
-        rval = LP_new_col(lp, pi, lb, MILP_INFINITY, 'C');
+        // ray in T
+        rval = LP_new_col(lp, 0.0, 0.0, 0.0, 'C');
         abort_if(rval, "LP_new_col failed");
 
-        if(i < nrays)
-            map[i] = rx_count++;
+        map[i] = 2 * (rx_count++);
     }
 
     log_verbose("rx_count=%d\n", rx_count);
 
+    lambda_x = 2 * rx_count;
+    rval = LP_new_col(lp, 0.0, -MILP_INFINITY, MILP_INFINITY, 'C');
+    abort_if(rval, "LP_new_col failed");
+
     // create y variables
     for(int i = 0; i < nrows; i++)
     {
@@ -230,19 +214,19 @@ static int create_find_epsilon_lp(int nrows,
 
         for(int i = 0; i < nrays; i++)
         {
-            if(!t[i]) continue;
+            if(!rx[i]) continue;
             const double *ri = &rays[i * nrows];
 
-            rmatind[nz] = map[i];
+            rmatind[nz] = map[i] + 1;
             rmatval[nz] = f[j] + beta[i] * ri[j];
             nz++;
         }
 
-        rmatind[nz] = rx_count;
+        rmatind[nz] = lambda_x;
         rmatval[nz] = x[j];
         nz++;
 
-        rmatind[nz] = rx_count + j + 1;
+        rmatind[nz] = lambda_x + j + 1;
         rmatval[nz] = -1.0;
         nz++;
 
@@ -259,7 +243,7 @@ static int create_find_epsilon_lp(int nrows,
 
         for(int i = 0; i < nrays; i++)
         {
-            if(!rx[i] || t[i]) continue;
+            if(!rx[i]) continue;
             const double *ri = &rays[i * nrows];
 
             rmatind[nz] = map[i];
@@ -267,7 +251,7 @@ static int create_find_epsilon_lp(int nrows,
             nz++;
         }
 
-        rmatind[nz] = rx_count + j + 1;
+        rmatind[nz] = lambda_x + j + 1;
         rmatval[nz] = 1.0;
         nz++;
 
@@ -282,13 +266,13 @@ static int create_find_epsilon_lp(int nrows,
 
     for(int i = 0; i < nrays; i++)
     {
-        if(!t[i]) continue;
-        rmatind[nz] = map[i];
+        if(!rx[i]) continue;
+        rmatind[nz] = map[i] + 1;
         rmatval[nz] = 1.0;
         nz++;
     }
 
-    rmatind[nz] = rx_count;
+    rmatind[nz] = lambda_x;
     rmatval[nz] = 1.0;
     nz++;
 
@@ -298,17 +282,32 @@ static int create_find_epsilon_lp(int nrows,
     rval = LP_relax(lp);
     abort_if(rval, "LP_relax failed");
 
-    //rval = LP_write(lp, "find-epsilon.lp");
-    //abort_if(rval, "LP_write failed");
-
-
 CLEANUP:
-    if(map) free(map);
     if(rmatind) free(rmatind);
     if(rmatval) free(rmatval);
     return rval;
 }
 
+/*
+ * Moves the given ray into T, in the LP built by create_find_epsilon_lp.
+ */
+static int find_epsilon_lp_add_to_t(struct LP *lp, int column)
+{
+    int rval = 0;
+
+    rval = LP_change_bound(lp, column, 'U', 0.0);
+    abort_if(rval, "LP_change_bound failed");
+
+    rval = LP_change_bound(lp, column + 1, 'L', -MILP_INFINITY);
+    abort_if(rval, "LP_change_bound failed");
+
+    rval = LP_change_bound(lp, column + 1, 'U', MILP_INFINITY);
+    abort_if(rval, "LP_change_bound failed");
+
+CLEANUP:
+    return rval;
+}
+
 static int create_tight_rays_lp(int nrows,
                                 int nrays,
                                 const double *f,
@@ -567,6 +566,21 @@ CLEANUP:
     return rval;
 }
 
+/*
+ * Looks for a lattice point in the interior of conv{f + min(beta_i, epsilon)
+ * r_i} by enumerating the lattice points in its bounding box. If the box has
+ * more than MAX_ENUM_POINTS points, only a smaller box around f is
+ * enumerated. The gauge psi is evaluated for all points at once, using the
+ * facets of the set. Returns found = 0 if no point is found, or if the facets
+ * are not available or too expensive to compute, in which case the caller
+ * should solve the S-free MIP.
+ *
+ * This is called once per interior point found, each time with a different
+ * epsilon, so the facets are computed again on every call. In two and three
+ * dimensions this takes a convex hull. In higher dimensions every subset of
+ * nrows rays is visited, so models with more than MAX_ENUM_FACET_SUBSETS such
+ * subsets are left to the MIP.
+ */
 static int find_interior_point_enum(const int nrows,
                                     const int nrays,
                                     const double *f,
@@ -578,96 +592,248 @@ static int find_interior_point_enum(const int nrows,
 {
     int rval = 0;
 
-    int M = 1;
-    struct LP lp;
+    long count = 1;
     double best_value = INFINITY;
+    long best = -1;
+
+    // radius of the largest box around f with at most MAX_ENUM_POINTS points
+    int radius = (int) ((pow(MAX_ENUM_POINTS, 1.0 / nrows) - 2) / 2);
+
     double *beta2 = 0;
+    double *points = 0;
+    double *values = 0;
+    int *lb = 0;
+    int *ub = 0;
+    int *k = 0;
+
+    struct ConvLFreeSet lfree;
+    lfree.f = (double*) f;
+    lfree.nrows = nrows;
+    lfree.rays.dim = nrows;
+    lfree.rays.nrays = nrays;
+    lfree.rays.values = (double*) rays;
+    lfree.n_halfspaces = 0;
+    lfree.halfspaces = 0;
 
-    abort_if(nrows != 3, "not implemented");
+    *found = 0;
+
+    abort_if(nrows < MIN_ENUM_ROWS || nrows > MAX_ENUM_ROWS,
+            "invalid number of rows");
+
+    if(nrows > 3)
+    {
+        double n_subsets = 1;
+        for(int j = 1; j <= nrows; j++)
+            n_subsets = n_subsets * (nrays - nrows + j) / j;
+
+        if(n_subsets > MAX_ENUM_FACET_SUBSETS) goto CLEANUP;
+    }
 
     beta2 = (double *) malloc(nrays * sizeof(double));
+    lb = (int *) malloc(nrows * sizeof(int));
+    ub = (int *) malloc(nrows * sizeof(int));
+    k = (int *) malloc(nrows * sizeof(int));
     abort_if(!beta2, "could not allocate beta2");
+    abort_if(!lb, "could not allocate lb");
+    abort_if(!ub, "could not allocate ub");
+    abort_if(!k, "could not allocate k");
 
     for(int i = 0; i < nrays; i++)
-    {
         beta2[i] = fmin(epsilon, beta[i]);
+
+    lfree.beta = beta2;
+
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+
+    if(lfree.n_halfspaces == 0) goto CLEANUP;
+
+    for(int j = 0; j < nrows; j++)
+    {
+        double lo = f[j];
+        double hi = f[j];
+
+        for(int i = 0; i < nrays; i++)
+        {
+            double v = f[j] + beta2[i] * rays[i * nrows + j];
+            lo = fmin(lo, v);
+            hi = fmax(hi, v);
+        }
+
+        lb[j] = (int) fmax(ceil(lo), -INFINITY_BIG_E);
+        ub[j] = (int) fmin(floor(hi), INFINITY_BIG_E);
+        count *= max(0, ub[j] - lb[j] + 1);
     }
 
-    rval = LP_open(&lp);
-    abort_if(rval, "LP_open failed");
+    if(count > MAX_ENUM_POINTS)
+    {
+        count = 1;
+        for(int j = 0; j < nrows; j++)
+        {
+            int center = (int) floor(f[j]);
+            lb[j] = max(lb[j], center - radius);
+            ub[j] = min(ub[j], center + 1 + radius);
+            count *= max(0, ub[j] - lb[j] + 1);
+        }
+    }
 
-    struct ConvLFreeSet lfree;
-    lfree.f = (double*) f;
-    lfree.nrows = nrows;
-    lfree.rays.dim = nrows;
-    lfree.rays.nrays = nrays;
-    lfree.rays.values = (double*) rays;
-    lfree.beta = beta2;
+    if(count == 0) goto CLEANUP;
 
-    rval = INFINITY_create_psi_lp(&lfree, &lp);
-    abort_if(rval, "INFINITY_create_psi_lp failed");
+    points = (double *) malloc(count * nrows * sizeof(double));
+    values = (double *) malloc(count * sizeof(double));
+    abort_if(!points, "could not allocate points");
+    abort_if(!values, "could not allocate values");
 
-    *found = 0;
+    for(int j = 0; j < nrows; j++)
+        k[j] = lb[j];
+
+    for(long p = 0; p < count; p++)
+    {
+        for(int j = 0; j < nrows; j++)
+            points[p * nrows + j] = k[j] - f[j];
 
-    for(int x1 = -M; x1 <= M; x1++)
-        for(int x2 = -M; x2 <= M; x2++)
-            for(int x3 = -M; x3 <= M; x3++)
+        for(int j = 0; j < nrows; j++)
+        {
+            if(k[j] < ub[j])
             {
-                double value;
-                double q[3] = {x1 - f[0],
-                               x2 - f[1],
-                               x3 - f[2]};
+                k[j]++;
+                break;
+            }
 
-                rval = INFINITY_psi(nrows, q, 1, &lp, &value);
-                abort_if(rval, "INFINITY_psi failed");
+            k[j] = lb[j];
+        }
+    }
 
-                log_debug("        x=[%3d %3d %3d] value=%.12lf\n",
-                        x1, x2, x3, value);
+    rval = LINALG_max_product(lfree.n_halfspaces, (int) count, nrows,
+            lfree.halfspaces, points, values);
+    abort_if(rval, "LINALG_max_product failed");
 
-                if(value < best_value)
-                {
-                    best_value = value;
-                    x[0] = x1;
-                    x[1] = x2;
-                    x[2] = x3;
-                }
-            }
+    for(long p = 0; p < count; p++)
+    {
+        if(values[p] < best_value)
+        {
+            best_value = values[p];
+            best = p;
+        }
+    }
 
-    if(best_value < 0.999) *found = 1;
+    log_debug("        %ld points enumerated, best value=%.12lf\n", count,
+            best_value);
+
+    if(best_value < 0.999)
+    {
+        *found = 1;
+        for(int j = 0; j < nrows; j++)
+            x[j] = points[best * nrows + j] + f[j];
+    }
 
 CLEANUP:
+    if(lfree.halfspaces) free(lfree.halfspaces);
     if(beta2) free(beta2);
-    LP_free(&lp);
+    if(points) free(points);
+    if(values) free(values);
+    if(lb) free(lb);
+    if(ub) free(ub);
+    if(k) free(k);
     return rval;
 }
 
+/*
+ * S-free MIP kept across the iterations of INFINITY_ND_generate_lfree. Only
+ * the coefficients of the s variables depend on beta and epsilon, so these
+ * are changed in place, instead of building the MIP again.
+ */
+struct SFreeMIP
+{
+    struct LP lp;
+
+    int *rows;
+    int *cols;
+    double *values;
+};
+
+static int sfree_mip_init(struct SFreeMIP *mip, int nrows, int nrays)
+{
+    int rval = 0;
+
+    mip->lp.cplex_env = 0;
+    mip->lp.cplex_lp = 0;
+
+    mip->rows = (int *) malloc(nrows * nrays * sizeof(int));
+    mip->cols = (int *) malloc(nrows * nrays * sizeof(int));
+    mip->values = (double *) malloc(nrows * nrays * sizeof(double));
+    abort_if(!mip->rows, "could not allocate mip->rows");
+    abort_if(!mip->cols, "could not allocate mip->cols");
+    abort_if(!mip->values, "could not allocate mip->values");
+
+    for (int i = 0; i < nrows; i++)
+    {
+        for (int j = 0; j < nrays; j++)
+        {
+            mip->rows[i * nrays + j] = i + 1;
+            mip->cols[i * nrays + j] = j + nrows;
+        }
+    }
+
+CLEANUP:
+    return rval;
+}
+
+static void sfree_mip_free(struct SFreeMIP *mip)
+{
+    if(!mip) return;
+    LP_pool_release(&mip->lp);
+    if(mip->rows) free(mip->rows);
+    if(mip->cols) free(mip->cols);
+    if(mip->values) free(mip->values);
+}
+
 static int find_interior_point_cplex(const int nrows,
                                      const int nrays,
                                      const double *f,
                                      const double *rays,
                                      const double *beta,
                                      const double epsilon,
+                                     struct SFreeMIP *mip,
+                                     struct InfinityStats *stats,
                                      double *x,
                                      int *found)
 {
     int rval = 0;
-    struct LP lp;
     double initial_time;
     int infeasible;
     double objval;
 
-    rval = LP_open(&lp);
-    abort_if(rval, "LP_open failed");
-
-    lp_count++;
-    sfree_mip_count++;
+    stats->lp_count++;
+    stats->sfree_mip_count++;
     initial_time = get_user_time();
 
-    rval = create_sfree_mip(nrows, nrays, f, rays, beta, epsilon, &lp);
-    abort_if(rval, "greate_sfree_mip failed");
+    if(!mip->lp.cplex_lp)
+    {
+        rval = LP_pool_acquire(&mip->lp);
+        abort_if(rval, "LP_pool_acquire failed");
+
+        rval = create_sfree_mip(nrows, nrays, f, rays, beta, epsilon,
+                &mip->lp);
+        abort_if(rval, "greate_sfree_mip failed");
+    }
+    else
+    {
+        // update coefficients -min{e,e_j} R_ji of the s variables
+        for (int i = 0; i < nrows; i++)
+            for (int j = 0; j < nrays; j++)
+                mip->values[i * nrays + j] =
+                        -rays[nrows * j + i] * fmin(epsilon, beta[j]);
+
+        rval = LP_change_coefs(&mip->lp, nrows * nrays, mip->rows, mip->cols,
+                mip->values);
+        abort_if(rval, "LP_change_coefs failed");
+    }
 
+    // The first row bounds the objective by one, so no cutoff is needed: nodes
+    // whose relaxation has a larger objective are already infeasible
     log_debug("    solving sfree mip...\n");
-    rval = LP_optimize(&lp, &infeasible);
+    rval = LP_optimize(&mip->lp, &infeasible);
     if(rval == ERR_MIP_TIMEOUT) goto CLEANUP;
     abort_if(rval, "LP_optimize failed");
 
@@ -678,7 +844,7 @@ static int find_interior_point_cplex(const int nrows,
         goto CLEANUP;
     }
 
-    rval = LP_get_x(&lp, x);
+    rval = LP_get_x(&mip->lp, x);
     abort_if(rval, "LP_get_x failed");
 
     if_verbose_level
@@ -691,7 +857,7 @@ static int find_interior_point_cplex(const int nrows,
                     log_verbose("    t%d = %.8lf\n", i, x[i + nrows]);
     }
 
-    rval = LP_get_obj_val(&lp, &objval);
+    rval = LP_get_obj_val(&mip->lp, &objval);
     abort_if(rval, "LP_get_obj_val failed");
 
     log_debug("        obj: %.8lf\n", objval);
@@ -705,11 +871,10 @@ static int find_interior_point_cplex(const int nrows,
 
     *found = 1;
 
-    sfree_mip_time += get_user_time() - initial_time;
-    lp_time += get_user_time() - initial_time;
+    stats->sfree_mip_time += get_user_time() - initial_time;
+    stats->lp_time += get_user_time() - initial_time;
 
 CLEANUP:
-    LP_free(&lp);
     return rval;
 }
 
@@ -720,50 +885,58 @@ static int cone_bound(int nrows,
                       const int *rx,
                       const double *x,
                       const double *beta,
+                      struct InfinityStats *stats,
                       double *epsilon)
 {
     log_verbose("      find_epsilon\n");
     int rval = 0;
 
     int *t = 0;
+    int *map = 0;
     long it = 0;
+    struct LP lp = {0, 0};
+    double initial_time;
 
     t = (int *) malloc(nrays * sizeof(int));
+    map = (int *) malloc(nrays * sizeof(int));
     abort_if(!t, "could not allocate t");
+    abort_if(!map, "could not allocate map");
 
     for(int i = 0; i < nrays; i++)
         t[i] = 0;
 
+    initial_time = get_user_time();
+
+    rval = LP_pool_acquire(&lp);
+    abort_if(rval, "LP_pool_acquire failed");
+
+    rval = create_find_epsilon_lp(nrows, nrays, f, rays, rx, x, beta, map,
+            &lp);
+    abort_if(rval, "create_find_epsilon_lp failed");
+
     while(1)
     {
         it++;
         log_verbose("Starting iteration %d...\n", it);
 
-        struct LP lp;
-
-        double initial_time = get_user_time();
-        rval = LP_open(&lp);
-        abort_if(rval, "LP_open failed");
-
-        rval = create_find_epsilon_lp(nrows, nrays, f, rays, t, rx, x, beta,
-                &lp);
-        abort_if(rval, "create_find_epsilon_lp failed");
+        if(it > 1) initial_time = get_user_time();
 
+        // after the first iteration, the dual simplex starts from the
+        // previous optimal basis
         int infeasible;
         rval = LP_optimize(&lp, &infeasible);
         abort_if(rval, "LP_optimize failed");
 
-        lp_count++;
-        lp_time += get_user_time() - initial_time;
+        stats->lp_count++;
+        stats->lp_time += get_user_time() - initial_time;
 
-        epsilon_lp_count++;
-        epsilon_lp_time += get_user_time() - initial_time;
+        stats->epsilon_lp_count++;
+        stats->epsilon_lp_time += get_user_time() - initial_time;
 
         if(infeasible)
         {
             *epsilon = INFINITY;
             log_verbose("  infeasible\n");
-            LP_free(&lp);
             goto CLEANUP;
         }
 
@@ -779,8 +952,6 @@ static int cone_bound(int nrows,
             log_verbose("  beta[%d]=%.6lf\n", i, beta[i]);
         }
 
-        LP_free(&lp);
-
         double e_min = INFINITY;
         double e_max = -INFINITY;
 
@@ -811,14 +982,23 @@ static int cone_bound(int nrows,
         else
         {
             for(int i = 0; i < nrays; i++)
-                if(rx[i] && DOUBLE_eq(beta[i], e_min))
+            {
+                if(rx[i] && !t[i] && DOUBLE_eq(beta[i], e_min))
+                {
                     t[i] = 1;
+
+                    rval = find_epsilon_lp_add_to_t(&lp, map[i]);
+                    abort_if(rval, "find_epsilon_lp_add_to_t failed");
+                }
+            }
         }
     }
 
 CLEANUP:
     log_verbose("  e=%.6lf\n", *epsilon);
+    LP_pool_release(&lp);
     if(t) free(t);
+    if(map) free(map);
     return rval;
 }
 
@@ -829,6 +1009,7 @@ static int find_tight_rays(int nrows,
                            const double *x,
                            const double *beta,
                            double epsilon,
+                           struct InfinityStats *stats,
                            int *tx)
 {
     log_verbose("      find_tight_rays\n");
@@ -837,15 +1018,15 @@ static int find_tight_rays(int nrows,
     double initial_time = 0;
     const double delta = 0.001;
 
-    struct LP lp;
+    struct LP lp = {0, 0};
     double *sbar = 0;
 
     sbar = (double *) malloc(2 * nrays * sizeof(double));
     abort_if(!sbar, "could not allocate sbar");
 
     initial_time = get_user_time();
-    rval = LP_open(&lp);
-    abort_if(rval, "LP_open failed");
+    rval = LP_pool_acquire(&lp);
+    abort_if(rval, "LP_pool_acquire failed");
 
     rval = create_tight_rays_lp(nrows, nrays, f, rays, x, beta, epsilon, delta,
             &lp);
@@ -854,11 +1035,11 @@ static int find_tight_rays(int nrows,
     rval = LP_optimize(&lp, &infeasible);
     abort_if(rval, "LP_optimize failed");
 
-    lp_count++;
-    lp_time += get_user_time() - initial_time;
+    stats->lp_count++;
+    stats->lp_time += get_user_time() - initial_time;
 
-    tight_lp_count++;
-    tight_lp_time += get_user_time() - initial_time;
+    stats->tight_lp_count++;
+    stats->tight_lp_time += get_user_time() - initial_time;
 
     abort_if(infeasible, "tight_rays_lp is infeasible");
 
@@ -873,7 +1054,7 @@ static int find_tight_rays(int nrows,
 
 CLEANUP:
     if(sbar) free(sbar);
-    LP_free(&lp);
+    LP_pool_release(&lp);
     return rval;
 }
 
@@ -884,6 +1065,7 @@ static int find_violated_cone(int nrows,
                               const double *x,
                               const double *beta,
                               double epsilon,
+                              struct InfinityStats *stats,
                               int *rx,
                               double *sbar,
                               int *violated_found)
@@ -891,12 +1073,12 @@ static int find_violated_cone(int nrows,
     log_debug("    finding violated cone:\n");
     int rval = 0;
 
-    struct LP lp;
+    struct LP lp = {0, 0};
 
     double initial_time = get_user_time();
 
-    rval = LP_open(&lp);
-    abort_if(rval, "LP_open failed");
+    rval = LP_pool_acquire(&lp);
+    abort_if(rval, "LP_pool_acquire failed");
 
     rval = create_violated_cone_lp(nrows, nrays, f, rays, x, beta, epsilon,
             &lp);
@@ -906,11 +1088,11 @@ static int find_violated_cone(int nrows,
     rval = LP_optimize(&lp, &infeasible);
     abort_if(rval, "LP_optimize failed");
 
-    lp_count++;
-    lp_time += get_user_time() - initial_time;
+    stats->lp_count++;
+    stats->lp_time += get_user_time() - initial_time;
 
-    violated_lp_count++;
-    violated_lp_time += get_user_time() - initial_time;
+    stats->violated_lp_count++;
+    stats->violated_lp_time += get_user_time() - initial_time;
 
     rval = LP_get_x(&lp, sbar);
     abort_if(rval, "LP_get_x failed");
@@ -954,7 +1136,7 @@ static int find_violated_cone(int nrows,
     }
 
 CLEANUP:
-    LP_free(&lp);
+    LP_pool_release(&lp);
     return rval;
 }
 
@@ -964,6 +1146,7 @@ static int bound(int nrows,
                  const double *rays,
                  const double *x,
                  const double *beta,
+                 struct InfinityStats *stats,
                  double *epsilon,
                  int *tx)
 {
@@ -991,8 +1174,8 @@ static int bound(int nrows,
         count++;
         abort_if(count > 100, "infinite loop");
 
-        rval = find_violated_cone(nrows, nrays, f, rays, x, beta, *epsilon, rx,
-                sbar, &found);
+        rval = find_violated_cone(nrows, nrays, f, rays, x, beta, *epsilon,
+                stats, rx, sbar, &found);
         abort_if(rval, "find_violated_cone failed");
 
         if(!found) break;
@@ -1011,7 +1194,8 @@ static int bound(int nrows,
 
         prev_epsilon = *epsilon;
 
-        rval = cone_bound(nrows, nrays, fbar, rays, rx, x, beta, epsilon);
+        rval = cone_bound(nrows, nrays, fbar, rays, rx, x, beta, stats,
+                epsilon);
         abort_if(rval, "cone_bound failed");
 
         log_debug("    cone bound: %.20lf\n", epsilon);
@@ -1028,7 +1212,8 @@ static int bound(int nrows,
     }
     else
     {
-        rval = find_tight_rays(nrows, nrays, fbar, rays, x, beta, *epsilon, tx);
+        rval = find_tight_rays(nrows, nrays, fbar, rays, x, beta, *epsilon,
+                stats, tx);
         abort_if(rval, "find_tight_rays failed");
     }
 
@@ -1039,55 +1224,394 @@ CLEANUP:
     return rval;
 }
 
-static int scale_to_ahull(int nrows,
-                          int nrays,
-                          const double *rays,
-                          const int *rx,
-                          const double *beta,
-                          double epsilon,
-                          const double *d,
-                          double *alpha)
+/*
+ * Scale-to-ahull LP kept across the calls of one pass of
+ * INFINITY_ND_generate_lfree. Between calls, only the direction d and the
+ * scaled rays min(e, beta_r) r change, so their coefficients are changed in
+ * place and the LP is warm-started from the previous basis.
+ */
+struct ScaleToAhullLP
+{
+    struct LP lp;
+
+    int nrows;
+    int nrays;
+    const int *rx;
+    double *scales;
+
+    int *rows;
+    int *cols;
+    double *values;
+};
+
+static int scale_to_ahull_lp_init(struct ScaleToAhullLP *ahull,
+                                  int nrows,
+                                  int nrays,
+                                  const int *rx)
 {
-    log_verbose("      scale_to_ahull\n");
     int rval = 0;
-    *alpha = INFINITY;
+    int max_nz = nrows * (nrays + 1);
+
+    ahull->lp.cplex_env = 0;
+    ahull->lp.cplex_lp = 0;
+    ahull->nrows = nrows;
+    ahull->nrays = nrays;
+    ahull->rx = rx;
+
+    ahull->scales = (double *) malloc(nrays * sizeof(double));
+    ahull->rows = (int *) malloc(max_nz * sizeof(int));
+    ahull->cols = (int *) malloc(max_nz * sizeof(int));
+    ahull->values = (double *) malloc(max_nz * sizeof(double));
+    abort_if(!ahull->scales, "could not allocate ahull->scales");
+    abort_if(!ahull->rows, "could not allocate ahull->rows");
+    abort_if(!ahull->cols, "could not allocate ahull->cols");
+    abort_if(!ahull->values, "could not allocate ahull->values");
+
+CLEANUP:
+    return rval;
+}
+
+static void scale_to_ahull_lp_free(struct ScaleToAhullLP *ahull)
+{
+    if(!ahull) return;
+    LP_pool_release(&ahull->lp);
+    if(ahull->scales) free(ahull->scales);
+    if(ahull->rows) free(ahull->rows);
+    if(ahull->cols) free(ahull->cols);
+    if(ahull->values) free(ahull->values);
+}
+
+static int scale_to_ahull_lp_solve(struct ScaleToAhullLP *ahull,
+                                   const double *rays,
+                                   const double *beta,
+                                   double epsilon,
+                                   const double *d,
+                                   struct InfinityStats *stats,
+                                   double *alpha)
+{
+    int rval = 0;
+    int nrows = ahull->nrows;
+    int nrays = ahull->nrays;
+    const int *rx = ahull->rx;
 
-    struct LP lp;
     double *x = 0;
     double initial_time;
+    int infeasible;
+
+    *alpha = INFINITY;
 
     x = (double *) malloc((nrays + 1) * sizeof(double));
     abort_if(!x, "could not allocate x");
 
     initial_time = get_user_time();
-    rval = LP_open(&lp);
-    abort_if(rval, "LP_open failed");
 
-    rval = create_scale_to_ahull_lp(nrows, nrays, rays, rx, beta, epsilon, d,
-            &lp);
-    abort_if(rval, "create_scale_to_ahull_lp failed");
+    if(!ahull->lp.cplex_lp)
+    {
+        rval = LP_pool_acquire(&ahull->lp);
+        abort_if(rval, "LP_pool_acquire failed");
 
-    int infeasible;
-    rval = LP_optimize(&lp, &infeasible);
+        rval = create_scale_to_ahull_lp(nrows, nrays, rays, rx, beta, epsilon,
+                d, &ahull->lp);
+        abort_if(rval, "create_scale_to_ahull_lp failed");
+
+        for(int i = 0; i < nrays; i++)
+            ahull->scales[i] = min(epsilon, beta[i]);
+    }
+    else
+    {
+        int nz = 0;
+
+        for(int j = 0; j < nrows; j++)
+        {
+            ahull->rows[nz] = j;
+            ahull->cols[nz] = 0;
+            ahull->values[nz] = d[j];
+            nz++;
+        }
+
+        for(int i = 0; i < nrays; i++)
+        {
+            double scale = min(epsilon, beta[i]);
+            if(!rx[i] || scale == ahull->scales[i]) continue;
+
+            const double *ri = &rays[i * nrows];
+            for(int j = 0; j < nrows; j++)
+            {
+                ahull->rows[nz] = j;
+                ahull->cols[nz] = 1 + i;
+                ahull->values[nz] = -scale * ri[j];
+                nz++;
+            }
+
+            ahull->scales[i] = scale;
+        }
+
+        rval = LP_change_coefs(&ahull->lp, nz, ahull->rows, ahull->cols,
+                ahull->values);
+        abort_if(rval, "LP_change_coefs failed");
+    }
+
+    rval = LP_optimize(&ahull->lp, &infeasible);
     abort_if(rval, "LP_optimize failed");
 
-    lp_count++;
-    lp_time += get_user_time() - initial_time;
+    stats->lp_count++;
+    stats->lp_time += get_user_time() - initial_time;
 
-    scale_ahull_lp_count++;
-    scale_ahull_lp_time += get_user_time() - initial_time;
+    stats->scale_ahull_lp_count++;
+    stats->scale_ahull_lp_time += get_user_time() - initial_time;
 
     if(infeasible)
         goto CLEANUP;
 
-    rval = LP_get_x(&lp, x);
+    rval = LP_get_x(&ahull->lp, x);
     abort_if(rval, "LP_get_x failed");
 
     *alpha = x[0];
 
 CLEANUP:
     if(x) free(x);
-    LP_free(&lp);
+    return rval;
+}
+
+static int scale_to_ahull(int nrows,
+                          int nrays,
+                          const double *rays,
+                          const int *rx,
+                          const double *beta,
+                          double epsilon,
+                          const double *d,
+                          struct InfinityStats *stats,
+                          double *alpha)
+{
+    log_verbose("      scale_to_ahull\n");
+    int rval = 0;
+    struct ScaleToAhullLP ahull;
+
+    rval = scale_to_ahull_lp_init(&ahull, nrows, nrays, rx);
+    abort_if(rval, "scale_to_ahull_lp_init failed");
+
+    rval = scale_to_ahull_lp_solve(&ahull, rays, beta, epsilon, d, stats,
+            alpha);
+    abort_if(rval, "scale_to_ahull_lp_solve failed");
+
+CLEANUP:
+    scale_to_ahull_lp_free(&ahull);
+    return rval;
+}
+
+struct LatticeCandidate
+{
+    double bound;
+    int offset;
+};
+
+static int _qsort_cmp_lattice_candidates(const void *p1, const void *p2)
+{
+    double b1 = ((const struct LatticeCandidate *) p1)->bound;
+    double b2 = ((const struct LatticeCandidate *) p2)->bound;
+    return (b1 > b2) - (b1 < b2);
+}
+
+static int evaluate_psi(const int nrows,
+                        const double *x,
+                        struct LP *lp,
+                        const struct ConvLFreeSet *lfree,
+                        double *value)
+{
+    int rval = 0;
+
+    if(lp)
+    {
+        rval = INFINITY_psi(nrows, x, 1, lp, value);
+        abort_if(rval, "INFINITY_psi failed");
+    }
+    else
+    {
+        rval = INFINITY_psi_halfspaces(nrows, x, 1, lfree, value);
+        abort_if(rval, "INFINITY_psi_halfspaces failed");
+    }
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Lower bound on psi_B(x), obtained from the bounding box [lb, ub] of B - f.
+ * Since x / psi_B(x) lies in this box, psi_B(x) >= x_j / ub_j for x_j > 0,
+ * and psi_B(x) >= x_j / lb_j for x_j < 0.
+ */
+static double psi_lower_bound(const int nrows,
+                              const double *x,
+                              const double *lb,
+                              const double *ub)
+{
+    double bound = 0;
+
+    for(int j = 0; j < nrows; j++)
+    {
+        if(x[j] > 0)
+            bound = fmax(bound, ub[j] > 0 ? x[j] / ub[j] : INFINITY);
+        else if(x[j] < 0)
+            bound = fmax(bound, lb[j] < 0 ? x[j] / lb[j] : INFINITY);
+    }
+
+    return bound;
+}
+
+/*
+ * Evaluates pi(q * q_scale) as the smallest value of psi over the integer
+ * translates frac(q * q_scale) + k, for k in [-MAX_LIFTING_RADIUS,
+ * MAX_LIFTING_RADIUS]^nrows. Translates are only evaluated if a lower bound
+ * on their value is smaller than the best value found so far, in increasing
+ * order of this bound. Psi is evaluated through the given LP or, if lp is
+ * null, through the facets of lfree.
+ */
+static int lattice_min_psi(const int nrows,
+                           const double *q,
+                           const double q_scale,
+                           struct LP *lp,
+                           const struct ConvLFreeSet *lfree,
+                           double *value)
+{
+    int rval = 0;
+    int M = MAX_LIFTING_RADIUS;
+    int ncandidates = 0;
+    long max_ncandidates = 1;
+    double best_value;
+
+    double *fq = 0;
+    double *x = 0;
+    double *lb = 0;
+    double *ub = 0;
+    int *k = 0;
+    int *k_min = 0;
+    int *k_max = 0;
+    int *shifts = 0;
+    struct LatticeCandidate *candidates = 0;
+
+    fq = (double *) malloc(nrows * sizeof(double));
+    x = (double *) malloc(nrows * sizeof(double));
+    lb = (double *) malloc(nrows * sizeof(double));
+    ub = (double *) malloc(nrows * sizeof(double));
+    k = (int *) malloc(nrows * sizeof(int));
+    k_min = (int *) malloc(nrows * sizeof(int));
+    k_max = (int *) malloc(nrows * sizeof(int));
+    abort_if(!fq, "could not allocate fq");
+    abort_if(!x, "could not allocate x");
+    abort_if(!lb, "could not allocate lb");
+    abort_if(!ub, "could not allocate ub");
+    abort_if(!k, "could not allocate k");
+    abort_if(!k_min, "could not allocate k_min");
+    abort_if(!k_max, "could not allocate k_max");
+
+    for(int j = 0; j < nrows; j++)
+    {
+        fq[j] = frac(q[j] * q_scale);
+        lb[j] = 0;
+        ub[j] = 0;
+    }
+
+    for(int i = 0; i < lfree->rays.nrays; i++)
+    {
+        const double *r = LFREE_get_ray(&lfree->rays, i);
+        for(int j = 0; j < nrows; j++)
+        {
+            lb[j] = fmin(lb[j], r[j] * lfree->beta[i]);
+            ub[j] = fmax(ub[j], r[j] * lfree->beta[i]);
+        }
+    }
+
+    rval = evaluate_psi(nrows, fq, lp, lfree, &best_value);
+    abort_if(rval, "evaluate_psi failed");
+
+    // only shifts satisfying best_value * lb < fq + k < best_value * ub can
+    // improve the best value
+    for(int j = 0; j < nrows; j++)
+    {
+        k_min[j] = -M;
+        k_max[j] = M;
+
+        if(isfinite(best_value))
+        {
+            k_min[j] = (int) fmax(-M, floor(best_value * lb[j] - fq[j]));
+            k_max[j] = (int) fmin(M, ceil(best_value * ub[j] - fq[j]));
+        }
+
+        if(k_min[j] > k_max[j]) goto DONE;
+        max_ncandidates *= k_max[j] - k_min[j] + 1;
+    }
+
+    candidates = (struct LatticeCandidate *) malloc(
+            max_ncandidates * sizeof(struct LatticeCandidate));
+    shifts = (int *) malloc(max_ncandidates * nrows * sizeof(int));
+    abort_if(!candidates, "could not allocate candidates");
+    abort_if(!shifts, "could not allocate shifts");
+
+    for(int j = 0; j < nrows; j++)
+        k[j] = k_min[j];
+
+    while(1)
+    {
+        int is_zero = 1;
+        for(int j = 0; j < nrows; j++)
+        {
+            x[j] = fq[j] + k[j];
+            if(k[j] != 0) is_zero = 0;
+        }
+
+        double bound = psi_lower_bound(nrows, x, lb, ub);
+
+        if(!is_zero && bound < best_value)
+        {
+            candidates[ncandidates].bound = bound;
+            candidates[ncandidates].offset = ncandidates * nrows;
+            memcpy(&shifts[ncandidates * nrows], k, nrows * sizeof(int));
+            ncandidates++;
+        }
+
+        int j = 0;
+        while(j < nrows && k[j] == k_max[j])
+        {
+            k[j] = k_min[j];
+            j++;
+        }
+
+        if(j == nrows) break;
+        k[j]++;
+    }
+
+    qsort(candidates, (size_t) ncandidates, sizeof(struct LatticeCandidate),
+            _qsort_cmp_lattice_candidates);
+
+    for(int i = 0; i < ncandidates; i++)
+    {
+        double v;
+        const int *shift = &shifts[candidates[i].offset];
+
+        if(candidates[i].bound >= best_value) break;
+
+        for(int j = 0; j < nrows; j++)
+            x[j] = fq[j] + shift[j];
+
+        rval = evaluate_psi(nrows, x, lp, lfree, &v);
+        abort_if(rval, "evaluate_psi failed");
+
+        best_value = min(best_value, v);
+    }
+
+DONE:
+    *value = best_value;
+
+CLEANUP:
+    if(fq) free(fq);
+    if(x) free(x);
+    if(lb) free(lb);
+    if(ub) free(ub);
+    if(k) free(k);
+    if(k_min) free(k_min);
+    if(k_max) free(k_max);
+    if(shifts) free(shifts);
+    if(candidates) free(candidates);
     return rval;
 }
 
@@ -1152,52 +1676,50 @@ CLEANUP:
 int INFINITY_pi(const int nrows,
                 const double *q,
                 const double q_scale,
+                const struct ConvLFreeSet *lfree,
                 struct LP *lp,
                 double *value)
 {
-    int rval = 0;
-
-    abort_if(nrows > 3, "not implemented");
-
-    double best_value = 1e100;
+    return lattice_min_psi(nrows, q, q_scale, lp, lfree, value);
+}
 
-    if(nrows == 2)
-    {
-        int M = 2;
-        for(int k0 = -M; k0 <= M; k0++)
-            for(int k1 = -M; k1 <= M; k1++)
-            {
-                double v;
-                double qk[] = {frac(q[0] * q_scale) + k0,
-                               frac(q[1] * q_scale) + k1};
+int INFINITY_pi_halfspaces(const int nrows,
+                           const double *q,
+                           const double q_scale,
+                           const struct ConvLFreeSet *lfree,
+                           double *value)
+{
+    return lattice_min_psi(nrows, q, q_scale, 0, lfree, value);
+}
 
-                rval = INFINITY_psi(nrows, qk, 1, lp, &v);
-                abort_if(rval, "INFINITY_psi failed");
+/*
+ * Evaluates psi_B(q * q_scale) in closed form, as the largest value of h q
+ * over the facets h (x - f) <= 1 of B. The facets must have been computed
+ * by LFREE_compute_conv_halfspaces.
+ */
+int INFINITY_psi_halfspaces(const int nrows,
+                            const double *q,
+                            const double q_scale,
+                            const struct ConvLFreeSet *lfree,
+                            double *value)
+{
+    int rval = 0;
+    double best_value = -INFINITY;
 
-                best_value = min(best_value, v);
-            }
-    }
+    abort_if(lfree->n_halfspaces <= 0, "halfspaces not available");
 
-    if(nrows == 3)
+    for(int k = 0; k < lfree->n_halfspaces; k++)
     {
-        int M = 2;
-        for(int k0 = -M; k0 <= M; k0++)
-            for(int k1 = -M; k1 <= M; k1++)
-                for(int k2 = -M; k2 <= M; k2++)
-                {
-                    double v;
-                    double qk[] = {frac(q[0] * q_scale) + k0,
-                                   frac(q[1] * q_scale) + k1,
-                                   frac(q[2] * q_scale) + k2};
+        const double *h = &lfree->halfspaces[k * nrows];
+        double v = 0;
 
-                    rval = INFINITY_psi(nrows, qk, 1, lp, &v);
-                    abort_if(rval, "INFINITY_psi failed");
+        for(int j = 0; j < nrows; j++)
+            v += h[j] * q[j];
 
-                    best_value = min(best_value, v);
-                }
+        best_value = max(best_value, v);
     }
 
-    *value = best_value;
+    *value = best_value * q_scale;
 
 CLEANUP:
     return rval;
@@ -1241,7 +1763,8 @@ CLEANUP:
 }
 
 int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
-                               struct ConvLFreeSet *lfree)
+                               struct ConvLFreeSet *lfree,
+                               struct InfinityStats *stats)
 {
     int rval = 0;
     int nrows = model->nrows;
@@ -1262,11 +1785,20 @@ int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
     int *t = 0;
     int *tx = 0;
 
+    struct SFreeMIP sfree_mip = {0};
+    struct ScaleToAhullLP ahull = {0};
+
+    rval = sfree_mip_init(&sfree_mip, nrows, nrays);
+    abort_if(rval, "sfree_mip_init failed");
+
     t = (int *) malloc(nrays * sizeof(int));
     tx = (int *) malloc(nrays * sizeof(int));
     abort_if(!t, "could not allocate t");
     abort_if(!tx, "could not allocate tx");
 
+    rval = scale_to_ahull_lp_init(&ahull, nrows, nrays, t);
+    abort_if(rval, "scale_to_ahull_lp_init failed");
+
     x = (double *) malloc((nrows + nrays) * sizeof(double));
     abort_if(!x, "could not allocate x");
 
@@ -1301,7 +1833,7 @@ int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
 
             int found = 0;
 
-            if(nrows == 3)
+            if(nrows >= MIN_ENUM_ROWS && nrows <= MAX_ENUM_ROWS)
             {
                 rval = find_interior_point_enum(nrows, nrays, f,
                         model->rays.values, beta, epsilon, x, &found);
@@ -1311,7 +1843,8 @@ int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
             if(!found)
             {
                 rval = find_interior_point_cplex(nrows, nrays, f,
-                        model->rays.values, beta, epsilon, x, &found);
+                        model->rays.values, beta, epsilon, &sfree_mip, stats,
+                        x, &found);
                 if(rval == ERR_MIP_TIMEOUT) goto CLEANUP;
                 abort_if(rval, "find_interior_point_cplex failed");
                 if(!found) break;
@@ -1331,7 +1864,7 @@ int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
 
             double epsilon_x;
             rval = bound(nrows, nrays, f, model->rays.values, x, beta,
-                    &epsilon_x, tx);
+                    stats, &epsilon_x, tx);
             abort_if(rval, "bound failed");
 
             abort_if(isinf(epsilon_x), "epsilon_x is infinite");
@@ -1367,9 +1900,9 @@ int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
                 double alpha;
                 const double *d = LFREE_get_ray(&model->rays, i);
 
-                rval = scale_to_ahull(nrows, nrays, model->rays.values, t, beta,
-                        epsilon, d, &alpha);
-                abort_if(rval, "scale_to_ahull failed");
+                rval = scale_to_ahull_lp_solve(&ahull, model->rays.values,
+                        beta, epsilon, d, stats, &alpha);
+                abort_if(rval, "scale_to_ahull_lp_solve failed");
 
                 if(DOUBLE_iszero(alpha))
                 {
@@ -1382,44 +1915,65 @@ int INFINITY_ND_generate_lfree(const struct MultiRowModel *model,
 
             log_debug("        beta[%2d]: %20.12lf\n", i, beta[i]);
         }
+
+        // T changes in the next pass, so the LP must be built again
+        LP_pool_release(&ahull.lp);
     }
 
     log_debug("    %6ld lattice points, %ld iterations\n", x_count, it);
 
-    log_debug("    %6ld MIPs (%.2lf ms per call, %.0lf ms total)\n", lp_count,
-            lp_time * 1000 / lp_count, lp_time * 1000);
-
-    log_debug(
-            "          %6ld S-free MIPs (%.2lf ms per call, %.0lf ms total)\n",
-            sfree_mip_count, sfree_mip_time * 1000 / sfree_mip_count,
-            sfree_mip_time * 1000);
-
-    log_debug(
-            "          %6ld epsilon LPs (%.2lf ms per call, %.0lf ms total)\n",
-            epsilon_lp_count, epsilon_lp_time * 1000 / epsilon_lp_count,
-            epsilon_lp_time * 1000);
-
-    log_debug(
-            "          %6ld tight-rays LPs (%.2lf ms per call, %.0lf ms total)\n",
-            tight_lp_count, tight_lp_time * 1000 / tight_lp_count,
-            tight_lp_time * 1000);
-
-    log_debug(
-            "          %6ld violated-cone LPs (%.2lf ms per call, %.0lf ms total)\n",
-            violated_lp_count, violated_lp_time * 1000 / violated_lp_count,
-            violated_lp_time * 1000);
-
-    log_debug(
-            "          %6ld scale-to-ahull LPs (%.2lf ms per call, %.0lf ms total)\n",
-            scale_ahull_lp_count,
-            scale_ahull_lp_time * 1000 / scale_ahull_lp_count,
-            scale_ahull_lp_time * 1000);
-
 CLEANUP:
+    sfree_mip_free(&sfree_mip);
+    scale_to_ahull_lp_free(&ahull);
     if(x) free(x);
     if(t) free(t);
     if(tx) free(tx);
     return rval;
 }
 
+void INFINITY_ND_merge_stats(struct InfinityStats *total,
+                             const struct InfinityStats *stats)
+{
+    total->lp_count += stats->lp_count;
+    total->lp_time += stats->lp_time;
+    total->epsilon_lp_count += stats->epsilon_lp_count;
+    total->epsilon_lp_time += stats->epsilon_lp_time;
+    total->tight_lp_count += stats->tight_lp_count;
+    total->tight_lp_time += stats->tight_lp_time;
+    total->violated_lp_count += stats->violated_lp_count;
+    total->violated_lp_time += stats->violated_lp_time;
+    total->sfree_mip_count += stats->sfree_mip_count;
+    total->sfree_mip_time += stats->sfree_mip_time;
+    total->scale_ahull_lp_count += stats->scale_ahull_lp_count;
+    total->scale_ahull_lp_time += stats->scale_ahull_lp_time;
+}
+
+static void print_lp_counter(const char *name, long count, double time)
+{
+    if(count == 0) return;
+
+    log_info("          %6ld %s (%.2lf ms per call, %.0lf ms total)\n", count,
+            name, time * 1000 / count, time * 1000);
+}
+
+void INFINITY_ND_print_stats(const struct InfinityStats *stats)
+{
+    if(stats->lp_count == 0) return;
+
+    log_info("    %6ld MIPs (%.2lf ms per call, %.0lf ms total)\n",
+            stats->lp_count, stats->lp_time * 1000 / stats->lp_count,
+            stats->lp_time * 1000);
+
+    print_lp_counter("S-free MIPs", stats->sfree_mip_count,
+            stats->sfree_mip_time);
+    print_lp_counter("epsilon LPs", stats->epsilon_lp_count,
+            stats->epsilon_lp_time);
+    print_lp_counter("tight-rays LPs", stats->tight_lp_count,
+            stats->tight_lp_time);
+    print_lp_counter("violated-cone LPs", stats->violated_lp_count,
+            stats->violated_lp_time);
+    print_lp_counter("scale-to-ahull LPs", stats->scale_ahull_lp_count,
+            stats->scale_ahull_lp_time);
+}
+
 #endif // TEST_SOURCE
\ No newline at end of file
@@ -16,10 +16,14 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#include <omp.h>
 
 #include <multirow/cg.h>
 #include <multirow/double.h>
 #include <multirow/util.h>
+#include <multirow/linalg.h>
+#include <multirow/stats.h>
 
 #include <infinity/infinity.h>
 #include <infinity/infinity-nd.h>
@@ -92,7 +96,14 @@ CLEANUP:
 }
 
 /**
- * Creates an intersection cut from the given lattice-free set.
+ * Creates an intersection cut from the given lattice-free set. If the facets
+ * of the set are available, the coefficients are evaluated in closed form.
+ * Otherwise, one LP is solved per coefficient.
+ *
+ * Since psi is positively homogeneous, it is evaluated only once for each
+ * ray of the model, and then multiplied by the scale of each variable that
+ * maps to that ray. The lifting function pi is not homogeneous, and is
+ * evaluated once per integer variable.
  *
  * @param tableau the tableau that was used to generate the model
  * @param map the mapping between the tableau and model
@@ -109,49 +120,76 @@ static int create_cut_from_lfree(const struct Tableau *tableau,
 {
     int rval = 0;
     double *ray = 0;
+    double *psi_values = 0;
 
-    struct LP lp;
+    struct LP lp = {0, 0};
     int nvars = map->nvars;
     int nrows = tableau->nrows;
+    int use_halfspaces = (lfree->n_halfspaces > 0);
     const struct RayList *rays = &model->rays;
 
-    rval = LP_open(&lp);
-    abort_if(rval, "LP_open failed");
-
     memcpy(lfree->f, model->f, nrows * sizeof(double));
 
-    rval = INFINITY_create_psi_lp(lfree, &lp);
-    abort_if(rval, "create_psi_lp failed");
+    if(!use_halfspaces)
+    {
+        rval = LP_pool_acquire(&lp);
+        abort_if(rval, "LP_pool_acquire failed");
+
+        rval = INFINITY_create_psi_lp(lfree, &lp);
+        abort_if(rval, "create_psi_lp failed");
+    }
 
     ray = (double*) malloc(nrows * sizeof(double));
+    psi_values = (double*) malloc(max(1, rays->nrays) * sizeof(double));
     abort_if(!ray, "could not allocate ray");
+    abort_if(!psi_values, "could not allocate psi_values");
+
+    if(use_halfspaces)
+    {
+        rval = LINALG_max_product(lfree->n_halfspaces, rays->nrays, nrows,
+                lfree->halfspaces, rays->values, psi_values);
+        abort_if(rval, "LINALG_max_product failed");
+    }
+    else
+    {
+        for(int k = 0; k < rays->nrays; k++)
+        {
+            rval = INFINITY_psi(nrows, LFREE_get_ray(rays, k), 1.0, &lp,
+                    &psi_values[k]);
+            abort_if(rval, "INFINITY_psi failed");
+        }
+    }
 
     cut->nz = nvars;
     for(int i = 0; i < nvars; i++)
     {
-        double value, norm = 0;
-        double *original_ray = LFREE_get_ray(rays, map->variable_to_ray[i]);
+        double value;
+        double norm = 0;
+        double scale = map->ray_scale[i];
+        int k = map->variable_to_ray[i];
+        double *original_ray = LFREE_get_ray(rays, k);
         char type = tableau->column_types[map->indices[i]];
 
         for (int j = 0; j < nrows; j++)
-        {
-            ray[j] = original_ray[j];
-            norm += fabs(ray[j]);
-        }
+            norm += fabs(original_ray[j]);
 
-        if (norm < 0.001)
-            for (int j = 0; j < nrows; j++)
-                ray[j] *= 0.001 / norm;
+        if (norm > 0 && norm * scale < 0.001)
+            scale = 0.001 / norm;
 
         if(ENABLE_LIFTING && type == MILP_INTEGER)
         {
-            rval = INFINITY_pi(nrows, ray, map->ray_scale[i], &lp, &value);
+            for (int j = 0; j < nrows; j++)
+                ray[j] = original_ray[j] * scale;
+
+            if(use_halfspaces)
+                rval = INFINITY_pi_halfspaces(nrows, ray, 1.0, lfree, &value);
+            else
+                rval = INFINITY_pi(nrows, ray, 1.0, lfree, &lp, &value);
             abort_if(rval, "INFINITY_pi failed");
         }
         else
         {
-            rval = INFINITY_psi(nrows, ray, map->ray_scale[i], &lp, &value);
-            abort_if(rval, "INFINITY_psi failed");
+            value = psi_values[k] * scale;
         }
 
         value *= 1.001;
@@ -166,79 +204,345 @@ static int create_cut_from_lfree(const struct Tableau *tableau,
 
 CLEANUP:
     if(ray) free(ray);
-    LP_free(&lp);
+    if(psi_values) free(psi_values);
+    LP_pool_release(&lp);
+    return rval;
+}
+
+/**
+ * Spatial hash of rays, used to find, among the rays inserted so far, one
+ * that is within a given L1 distance of a query ray. Space is divided into
+ * hypercubes whose side equals the distance, so that only the neighbouring
+ * cells of the query ray need to be visited.
+ */
+struct RayGrid
+{
+    int nrows;
+    double cell_size;
+    int radius;
+
+    int capacity;
+    long *keys;
+    int *heads;
+    int *next;
+
+    int n_kept;
+    int *kept;
+
+    long *base;
+    long *key;
+    long *offset;
+};
+
+/**
+ * Allocates a grid able to hold up to max_nrays rays of the given dimension.
+ *
+ * @param grid the grid to be initialized
+ * @param nrows the dimension of the rays
+ * @param max_nrays the maximum number of rays
+ * @return zero if successful, non-zero otherwise
+ */
+static int ray_grid_init(struct RayGrid *grid, int nrows, int max_nrays)
+{
+    int rval = 0;
+
+    grid->nrows = nrows;
+    grid->capacity = 16;
+    while(grid->capacity < 2 * max_nrays) grid->capacity *= 2;
+
+    grid->keys = (long*) malloc(grid->capacity * nrows * sizeof(long));
+    grid->heads = (int*) malloc(grid->capacity * sizeof(int));
+    grid->next = (int*) malloc((max_nrays + 1) * sizeof(int));
+    grid->kept = (int*) malloc((max_nrays + 1) * sizeof(int));
+    grid->base = (long*) malloc(nrows * sizeof(long));
+    grid->key = (long*) malloc(nrows * sizeof(long));
+    grid->offset = (long*) malloc(nrows * sizeof(long));
+    abort_if(!grid->keys, "could not allocate grid->keys");
+    abort_if(!grid->heads, "could not allocate grid->heads");
+    abort_if(!grid->next, "could not allocate grid->next");
+    abort_if(!grid->kept, "could not allocate grid->kept");
+    abort_if(!grid->base, "could not allocate grid->base");
+    abort_if(!grid->key, "could not allocate grid->key");
+    abort_if(!grid->offset, "could not allocate grid->offset");
+
+CLEANUP:
     return rval;
 }
 
+static void ray_grid_free(struct RayGrid *grid)
+{
+    if(grid->keys) free(grid->keys);
+    if(grid->heads) free(grid->heads);
+    if(grid->next) free(grid->next);
+    if(grid->kept) free(grid->kept);
+    if(grid->base) free(grid->base);
+    if(grid->key) free(grid->key);
+    if(grid->offset) free(grid->offset);
+}
+
+/**
+ * Removes all rays from the grid, and prepares it for queries with the given
+ * L1 distance.
+ */
+static void ray_grid_reset(struct RayGrid *grid, double distance)
+{
+    grid->n_kept = 0;
+    grid->radius = (distance > 0 ? 1 : 0);
+    grid->cell_size = (distance > 0 ? distance : 1 / 128.0);
+
+    for(int i = 0; i < grid->capacity; i++)
+        grid->heads[i] = -1;
+}
+
+/**
+ * Returns the slot of the hash table that holds the given cell, or the empty
+ * slot where the cell should be inserted.
+ */
+static int ray_grid_find_slot(const struct RayGrid *grid, const long *key)
+{
+    int nrows = grid->nrows;
+    unsigned long hash = 14695981039346656037UL;
+
+    for(int j = 0; j < nrows; j++)
+        hash = (hash ^ (unsigned long) key[j]) * 1099511628211UL;
+
+    int slot = (int) (hash & (unsigned long) (grid->capacity - 1));
+
+    while(grid->heads[slot] >= 0)
+    {
+        if(memcmp(&grid->keys[slot * nrows], key, nrows * sizeof(long)) == 0)
+            break;
+
+        slot = (slot + 1) & (grid->capacity - 1);
+    }
+
+    return slot;
+}
+
+static void ray_grid_compute_key(const struct RayGrid *grid,
+                                 const double *r,
+                                 long *key)
+{
+    for(int j = 0; j < grid->nrows; j++)
+        key[j] = (long) floor(r[j] / grid->cell_size);
+}
+
+/**
+ * Returns non-zero if some ray in the grid is within the given L1 distance
+ * of the ray r. If the grid holds fewer rays than there are neighbouring
+ * cells, the rays are simply scanned one by one.
+ */
+static int ray_grid_has_neighbor(struct RayGrid *grid,
+                                 const double *rays,
+                                 const double *r,
+                                 double distance)
+{
+    int nrows = grid->nrows;
+    long n_cells = 1;
+
+    for(int j = 0; j < nrows && n_cells <= grid->n_kept; j++)
+        n_cells *= 2 * grid->radius + 1;
+
+    if(n_cells > grid->n_kept)
+    {
+        for(int k = 0; k < grid->n_kept; k++)
+        {
+            const double *q = &rays[grid->kept[k] * nrows];
+
+            double norm = 0;
+            for(int j = 0; j < nrows; j++)
+                norm += fabs(r[j] - q[j]);
+
+            if(norm <= distance) return 1;
+        }
+
+        return 0;
+    }
+
+    long *base = grid->base;
+    long *key = grid->key;
+    long *offset = grid->offset;
+
+    ray_grid_compute_key(grid, r, base);
+
+    for(int j = 0; j < nrows; j++)
+        offset[j] = -grid->radius;
+
+    while(1)
+    {
+        for(int j = 0; j < nrows; j++)
+            key[j] = base[j] + offset[j];
+
+        int slot = ray_grid_find_slot(grid, key);
+
+        for(int i = grid->heads[slot]; i >= 0; i = grid->next[i])
+        {
+            const double *q = &rays[i * nrows];
+
+            double norm = 0;
+            for(int j = 0; j < nrows; j++)
+                norm += fabs(r[j] - q[j]);
+
+            if(norm <= distance) return 1;
+        }
+
+        int j = 0;
+        while(j < nrows && offset[j] == grid->radius)
+            offset[j++] = -grid->radius;
+
+        if(j == nrows) break;
+        offset[j]++;
+    }
+
+    return 0;
+}
+
+static void ray_grid_insert(struct RayGrid *grid,
+                            const double *rays,
+                            int index)
+{
+    int nrows = grid->nrows;
+
+    ray_grid_compute_key(grid, &rays[index * nrows], grid->key);
+    int slot = ray_grid_find_slot(grid, grid->key);
+
+    if(grid->heads[slot] < 0)
+        memcpy(&grid->keys[slot * nrows], grid->key, nrows * sizeof(long));
+
+    grid->next[index] = grid->heads[slot];
+    grid->heads[slot] = index;
+    grid->kept[grid->n_kept++] = index;
+}
+
+/**
+ * Selects, in order, each ray that is farther than the given L1 distance
+ * from every ray selected before it. The indices of the selected rays are
+ * stored in grid->kept.
+ *
+ * @param grid the grid used for the queries
+ * @param rays the rays, stored contiguously
+ * @param nrays the number of rays
+ * @param distance the L1 distance
+ * @return the number of selected rays
+ */
+static int select_distant_rays(struct RayGrid *grid,
+                               const double *rays,
+                               int nrays,
+                               double distance)
+{
+    ray_grid_reset(grid, distance);
+
+    for(int i = 0; i < nrays; i++)
+    {
+        const double *r = &rays[i * grid->nrows];
+        if(ray_grid_has_neighbor(grid, rays, r, distance)) continue;
+        ray_grid_insert(grid, rays, i);
+    }
+
+    return grid->n_kept;
+}
+
 /**
  * Given an original multi-row model, returns a simplified model with fewer
  * rays. For each subset of rays that are very close to each other, only one ray
  * is selected for the new model.
  *
+ * Rays are first rounded to multiples of 1/128. Then, the smallest cutoff
+ * in {0.0, 0.1, ..., 5.0} that leaves fewer than MAX_N_RAYS rays is found by
+ * binary search, and the rays selected with that cutoff are returned.
+ *
  * @param original_model the original model
  * @param[out] filtered_model the simplified model
- * @return
+ * @return zero if successful, non-zero otherwise
  */
 static int filter_model(const struct MultiRowModel *original_model,
                         struct MultiRowModel *filtered_model)
 {
     int rval = 0;
-    double *r = 0;
+    double *rounded = 0;
     double *f = filtered_model->f;
     int nrows = original_model->nrows;
     struct RayList *filtered_rays = &filtered_model->rays;
     const struct RayList *original_rays = &original_model->rays;
+    struct RayGrid grid = {0};
+
+    int n_rounded = 0;
+    int n_cutoffs = 0;
+    int selected = 0;
+    int count;
+    double cutoffs[100];
 
     memcpy(f, original_model->f, nrows * sizeof(double));
 
-    r = (double*) malloc(nrows * sizeof(double));
-    abort_if(!r, "could not allocate r");
+    rounded = (double*) malloc(max(1, original_rays->nrays) * nrows *
+            sizeof(double));
+    abort_if(!rounded, "could not allocate rounded");
 
-    for(double norm_cutoff = 0.00; norm_cutoff <= 5.0; norm_cutoff += 0.1)
+    for(int i = 0; i < original_rays->nrays; i++)
     {
-        filtered_rays->nrays = 0;
+        double norm = 0;
+        double *r = &rounded[n_rounded * nrows];
+
+        memcpy(r, LFREE_get_ray(original_rays, i), nrows * sizeof(double));
 
-        for(int i = 0; i < original_rays->nrays; i++)
+        for(int j = 0; j < nrows; j++)
         {
-            int keep = 1;
-            double norm = 0;
+            r[j] = (ceil(r[j] * 128) / 128);
+            norm += fabs(r[j]);
+        }
 
-            memcpy(r, LFREE_get_ray(original_rays, i), nrows * sizeof(double));
+        if(DOUBLE_iszero(norm)) continue;
+        n_rounded++;
+    }
 
-            for(int j = 0; j < nrows; j++)
-            {
-                r[j] = (ceil(r[j] * 128) / 128);
-                norm += fabs(r[j]);
-            }
+    for(double norm_cutoff = 0.00; norm_cutoff <= 5.0; norm_cutoff += 0.1)
+        cutoffs[n_cutoffs++] = norm_cutoff;
 
-            if(DOUBLE_iszero(norm)) continue;
+    rval = ray_grid_init(&grid, nrows, n_rounded);
+    abort_if(rval, "ray_grid_init failed");
 
-            for(int j = 0; j < (filtered_rays->nrays); j++)
-            {
-                double *q = LFREE_get_ray(filtered_rays, j);
+    count = select_distant_rays(&grid, rounded, n_rounded, cutoffs[0]);
+
+    if(count >= MAX_N_RAYS)
+    {
+        int lo = 1;
+        int hi = n_cutoffs - 1;
+        selected = hi;
 
-                norm = 0;
-                for(int k = 0; k < nrows; k++)
-                    norm += fabs(r[k] - q[k]);
+        while(lo <= hi)
+        {
+            int mid = (lo + hi) / 2;
 
-                if(norm <= norm_cutoff)
-                {
-                    keep = 0;
-                    break;
-                }
-            }
+            count = select_distant_rays(&grid, rounded, n_rounded,
+                    cutoffs[mid]);
 
-            if(keep) LFREE_push_ray(filtered_rays, r);
-        }
+            log_verbose("  norm_cutoff=%8.2lf nrays=%8d\n", cutoffs[mid],
+                    count);
 
-        log_verbose("  norm_cutoff=%8.2lf nrays=%8d\n", norm_cutoff,
-                filtered_model->rays.nrays);
+            if(count < MAX_N_RAYS)
+            {
+                selected = mid;
+                hi = mid - 1;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
 
-        if(filtered_rays->nrays < MAX_N_RAYS) break;
+        select_distant_rays(&grid, rounded, n_rounded, cutoffs[selected]);
     }
 
+    filtered_rays->nrays = 0;
+    for(int k = 0; k < grid.n_kept; k++)
+        LFREE_push_ray(filtered_rays, &rounded[grid.kept[k] * nrows]);
+
+    log_verbose("  norm_cutoff=%8.2lf nrays=%8d\n", cutoffs[selected],
+            filtered_rays->nrays);
+
 CLEANUP:
-    if(r) free(r);
+    ray_grid_free(&grid);
+    if(rounded) free(rounded);
     return rval;
 }
 
@@ -335,12 +639,13 @@ CLEANUP:
     return rval;
 }
 
-static int dump_cut(const struct ConvLFreeSet *lfree)
+static int dump_cut(struct InfinityContext *ctx,
+                    const struct ConvLFreeSet *lfree)
 {
     int rval = 0;
 
     char filename[100];
-    sprintf(filename, "cut-%03d.sage", DUMP_CUT_N++);
+    sprintf(filename, "cut-%d-%03d.sage", ctx->id, ctx->dump_cut_n++);
 
     time_printf("Writing %s...\n", filename);
     rval = write_lfree_to_sage_file(lfree, filename);
@@ -386,16 +691,182 @@ CLEANUP:
     return rval;
 }
 
+/**
+ * Returns non-zero if the two given lattice-free sets, computed from the same
+ * model, have approximately the same vertices.
+ *
+ * @param lfree1 the first lattice-free set
+ * @param lfree2 the second lattice-free set
+ */
+static int lfree_sets_agree(const struct ConvLFreeSet *lfree1,
+                            const struct ConvLFreeSet *lfree2)
+{
+    if(lfree1->rays.nrays != lfree2->rays.nrays) return 0;
+
+    for(int i = 0; i < lfree1->rays.nrays; i++)
+    {
+        const double *r = LFREE_get_ray(&lfree1->rays, i);
+
+        for(int j = 0; j < lfree1->nrows; j++)
+        {
+            double v1 = r[j] * lfree1->beta[i];
+            double v2 = r[j] * lfree2->beta[i];
+            if(fabs(v1 - v2) > 1e-4 * fmax(1.0, fabs(v1))) return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Computes the lattice-free set for the given model. Two-row models are
+ * handled by the combinatorial algorithm in infinity-2d.c, unless
+ * LFREE_2D_ALGORITHM says otherwise, or the 2D lattice search gives up
+ * after MAX_LATTICE_POINTS points, in which case the ND algorithm is used.
+ * In validation mode, both algorithms are run, and their results and
+ * running times are recorded in the statistics.
+ *
+ * @param model the multi-row model
+ * @param ctx the generator context
+ * @param[out] lfree the resulting lattice-free set
+ * @return zero if successful, non-zero otherwise
+ */
+static int generate_lfree(const struct MultiRowModel *model,
+                          struct InfinityContext *ctx,
+                          struct ConvLFreeSet *lfree)
+{
+    int rval = 0;
+    int agree;
+    double fast_time, nd_time;
+    struct ConvLFreeSet nd_lfree = {0};
+
+    if(model->nrows != 2 || LFREE_2D_ALGORITHM == LFREE_2D_ALGORITHM_ND)
+    {
+        rval = INFINITY_ND_generate_lfree(model, lfree, &ctx->stats);
+        if(rval == ERR_MIP_TIMEOUT) goto CLEANUP;
+        abort_if(rval, "INFINITY_ND_generate_lfree failed");
+        goto CLEANUP;
+    }
+
+    fast_time = omp_get_wtime();
+    rval = INFINITY_2D_generate_lfree(model, lfree);
+    if(rval == ERR_MIP_TIMEOUT)
+    {
+        log_debug("    too many lattice points; falling back to ND\n");
+        rval = INFINITY_ND_generate_lfree(model, lfree, &ctx->stats);
+        if(rval == ERR_MIP_TIMEOUT) goto CLEANUP;
+        abort_if(rval, "INFINITY_ND_generate_lfree failed");
+        goto CLEANUP;
+    }
+    abort_if(rval, "INFINITY_2D_generate_lfree failed");
+    fast_time = omp_get_wtime() - fast_time;
+
+    if(LFREE_2D_ALGORITHM != LFREE_2D_ALGORITHM_VALIDATE) goto CLEANUP;
+
+    rval = LFREE_init_conv(&nd_lfree, model->nrows, model->rays.nrays);
+    abort_if(rval, "LFREE_init_conv failed");
+
+    nd_time = omp_get_wtime();
+    rval = INFINITY_ND_generate_lfree(model, &nd_lfree, &ctx->stats);
+    if(rval == ERR_MIP_TIMEOUT) goto CLEANUP;
+    abort_if(rval, "INFINITY_ND_generate_lfree failed");
+    nd_time = omp_get_wtime() - nd_time;
+
+    agree = lfree_sets_agree(lfree, &nd_lfree);
+    if(!agree) log_warn("2D and ND lattice-free sets differ\n");
+
+    log_debug("    2D: %.3lf ms, ND: %.3lf ms\n", fast_time * 1000,
+            nd_time * 1000);
+
+    STATS_add_lfree_2d_validation(nd_time, fast_time, agree);
+
+CLEANUP:
+    LFREE_free_conv(&nd_lfree);
+    return rval;
+}
+
+/**
+ * Computes the lattice-free set for the given model, or retrieves it from
+ * the cache of the context, if the same model has been seen before.
+ *
+ * @param model the multi-row model
+ * @param ctx the generator context
+ * @param[out] lfree the resulting lattice-free set
+ * @return zero if successful, non-zero otherwise
+ */
+static int generate_lfree_cached(const struct MultiRowModel *model,
+                                 struct InfinityContext *ctx,
+                                 struct ConvLFreeSet *lfree)
+{
+    int rval = 0;
+    int found = 0;
+    int nrows = model->nrows;
+    struct LFreeCacheKey key = {0};
+
+    if(!ctx->cache || LFREE_2D_ALGORITHM == LFREE_2D_ALGORITHM_VALIDATE)
+    {
+        rval = generate_lfree(model, ctx, lfree);
+        goto CLEANUP;
+    }
+
+    rval = LFREE_CACHE_init_key(model, &key);
+    abort_if(rval, "LFREE_CACHE_init_key failed");
+
+    rval = LFREE_CACHE_lookup(ctx->cache, &key, lfree->beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+
+    if(found)
+    {
+        lfree->nrows = nrows;
+        lfree->rays.nrays = model->rays.nrays;
+        memcpy(lfree->rays.values, model->rays.values,
+                model->rays.nrays * nrows * sizeof(double));
+        memcpy(lfree->f, model->f, nrows * sizeof(double));
+        goto CLEANUP;
+    }
+
+    rval = generate_lfree(model, ctx, lfree);
+    if(rval) goto CLEANUP;
+
+    rval = LFREE_CACHE_insert(ctx->cache, &key, lfree->beta);
+    abort_if(rval, "LFREE_CACHE_insert failed");
+
+CLEANUP:
+    LFREE_CACHE_free_key(&key);
+    return rval;
+}
+
 #ifndef TEST_SOURCE
 
+/**
+ * Initializes a generator context, with cut dumping and caching disabled and
+ * all counters set to zero.
+ *
+ * @param ctx the context to be initialized
+ * @param id identifies the context in the names of dumped files
+ */
+void INFINITY_init_context(struct InfinityContext *ctx, int id)
+{
+    ctx->id = id;
+    ctx->should_dump_cuts = 0;
+    ctx->dump_cut_n = 0;
+    ctx->cache = 0;
+    memset(&ctx->stats, 0, sizeof(struct InfinityStats));
+}
+
 /**
  * Generates the infinity cut for a given tableau.
  *
  * @param tableau the tableau that should be used to generate the cut
+ * @param ctx the generator context, which must not be used concurrently by
+ *            other threads
  * @param[out] cut the resulting infinity cut
- * @return zero if successful, non-zero otherwise
+ * @return zero if successful, ERR_NO_CUT if no lattice-free set could be
+ *         found within the limits, non-zero otherwise
  */
-int INFINITY_generate_cut(const struct Tableau *tableau, struct Row *cut)
+int INFINITY_generate_cut(const struct Tableau *tableau,
+                          struct InfinityContext *ctx,
+                          struct Row *cut)
 {
     int rval = 0;
     int max_nrays = CG_total_nz(tableau) + 100;
@@ -436,15 +907,25 @@ int INFINITY_generate_cut(const struct Tableau *tableau, struct Row *cut)
         abort_if(rval, "CG_print_model failed");
     }
 
-    rval = INFINITY_ND_generate_lfree(&filtered_model, &lfree);
-    abort_if(rval, "INFINITY_ND_generate_lfree failed");
+    rval = generate_lfree_cached(&filtered_model, ctx, &lfree);
+    if(rval == ERR_MIP_TIMEOUT)
+    {
+        rval = ERR_NO_CUT;
+        goto CLEANUP;
+    }
+    abort_if(rval, "generate_lfree_cached failed");
 
-    if(SHOULD_DUMP_CUTS)
+    if(ctx->should_dump_cuts)
     {
-        rval = dump_cut(&lfree);
+        rval = dump_cut(ctx, &lfree);
         abort_if(rval, "dump_cut failed");
     }
 
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+
+    log_debug("    %d facets\n", lfree.n_halfspaces);
+
     rval = create_cut_from_lfree(tableau, &original_map, &original_model,
             &lfree, cut);
     abort_if(rval, "create_cut_from_lfree failed");
@@ -0,0 +1,281 @@
+/* Copyright (c) 2015 Alinson Xavier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <multirow/stats.h>
+#include <multirow/util.h>
+
+#include <infinity/lfree-cache.h>
+
+static unsigned long hash_values(const double *values, int length)
+{
+    unsigned long hash = 14695981039346656037UL;
+
+    for(int i = 0; i < length; i++)
+    {
+        unsigned long bits;
+
+        // Adding zero turns -0.0 into 0.0, so that both have the same hash
+        double v = values[i] + 0.0;
+        memcpy(&bits, &v, sizeof(bits));
+
+        hash = (hash ^ bits) * 1099511628211UL;
+    }
+
+    return hash;
+}
+
+static int keys_equal(const struct LFreeCacheKey *key1,
+                      const struct LFreeCacheKey *key2)
+{
+    if(key1->hash != key2->hash) return 0;
+    if(key1->nrows != key2->nrows) return 0;
+    if(key1->nrays != key2->nrays) return 0;
+
+    for(int i = 0; i < key1->length; i++)
+        if(key1->values[i] != key2->values[i]) return 0;
+
+    return 1;
+}
+
+static int find_entry(const struct LFreeCache *cache,
+                      const struct LFreeCacheKey *key)
+{
+    int bucket = (int) (key->hash % (unsigned long) cache->n_buckets);
+
+    for(int e = cache->buckets[bucket]; e >= 0;
+        e = cache->entries[e].bucket_next)
+    {
+        if(keys_equal(&cache->entries[e].key, key)) return e;
+    }
+
+    return -1;
+}
+
+static void bucket_remove(struct LFreeCache *cache, int e)
+{
+    struct LFreeCacheEntry *entry = &cache->entries[e];
+    int bucket = (int) (entry->key.hash % (unsigned long) cache->n_buckets);
+    int *link = &cache->buckets[bucket];
+
+    while(*link != e)
+        link = &cache->entries[*link].bucket_next;
+
+    *link = entry->bucket_next;
+}
+
+static void bucket_insert(struct LFreeCache *cache, int e)
+{
+    struct LFreeCacheEntry *entry = &cache->entries[e];
+    int bucket = (int) (entry->key.hash % (unsigned long) cache->n_buckets);
+
+    entry->bucket_next = cache->buckets[bucket];
+    cache->buckets[bucket] = e;
+}
+
+static void lru_remove(struct LFreeCache *cache, int e)
+{
+    struct LFreeCacheEntry *entry = &cache->entries[e];
+
+    if(entry->lru_prev >= 0)
+        cache->entries[entry->lru_prev].lru_next = entry->lru_next;
+    else
+        cache->lru_first = entry->lru_next;
+
+    if(entry->lru_next >= 0)
+        cache->entries[entry->lru_next].lru_prev = entry->lru_prev;
+    else
+        cache->lru_last = entry->lru_prev;
+}
+
+static void lru_push_front(struct LFreeCache *cache, int e)
+{
+    struct LFreeCacheEntry *entry = &cache->entries[e];
+
+    entry->lru_prev = -1;
+    entry->lru_next = cache->lru_first;
+
+    if(cache->lru_first >= 0)
+        cache->entries[cache->lru_first].lru_prev = e;
+    else
+        cache->lru_last = e;
+
+    cache->lru_first = e;
+}
+
+int LFREE_CACHE_init(struct LFreeCache *cache, int capacity)
+{
+    int rval = 0;
+
+    abort_if(capacity <= 0, "capacity must be positive");
+
+    cache->capacity = capacity;
+    cache->n_entries = 0;
+    cache->n_buckets = 2 * capacity + 1;
+    cache->lru_first = -1;
+    cache->lru_last = -1;
+    cache->evictions = 0;
+
+    cache->entries = (struct LFreeCacheEntry *) calloc(capacity,
+            sizeof(struct LFreeCacheEntry));
+    cache->buckets = (int *) malloc(cache->n_buckets * sizeof(int));
+    abort_if(!cache->entries, "could not allocate cache->entries");
+    abort_if(!cache->buckets, "could not allocate cache->buckets");
+
+    for(int i = 0; i < cache->n_buckets; i++)
+        cache->buckets[i] = -1;
+
+CLEANUP:
+    return rval;
+}
+
+void LFREE_CACHE_free(struct LFreeCache *cache)
+{
+    if(!cache) return;
+
+    if(cache->entries)
+    {
+        for(int e = 0; e < cache->n_entries; e++)
+        {
+            LFREE_CACHE_free_key(&cache->entries[e].key);
+            free(cache->entries[e].beta);
+        }
+        free(cache->entries);
+    }
+
+    if(cache->buckets) free(cache->buckets);
+    cache->entries = 0;
+    cache->buckets = 0;
+}
+
+int LFREE_CACHE_init_key(const struct MultiRowModel *model,
+                         struct LFreeCacheKey *key)
+{
+    int rval = 0;
+    int nrows = model->nrows;
+    int nrays = model->rays.nrays;
+
+    key->nrows = nrows;
+    key->nrays = nrays;
+    key->length = nrows * (nrays + 1);
+
+    key->values = (double *) malloc(key->length * sizeof(double));
+    abort_if(!key->values, "could not allocate key->values");
+
+    // Rays are kept in the order of the model. The lattice-free set found
+    // for a model depends on this order, so sharing entries between
+    // permutations of the same rays would make the cuts depend on which
+    // thread reached the cache first.
+    memcpy(key->values, model->f, nrows * sizeof(double));
+    memcpy(&key->values[nrows], model->rays.values,
+            nrays * nrows * sizeof(double));
+
+    key->hash = hash_values(key->values, key->length);
+    key->hash = (key->hash ^ (unsigned long) nrows) * 1099511628211UL;
+
+CLEANUP:
+    return rval;
+}
+
+void LFREE_CACHE_free_key(struct LFreeCacheKey *key)
+{
+    if(!key) return;
+    if(key->values) free(key->values);
+    key->values = 0;
+}
+
+int LFREE_CACHE_lookup(struct LFreeCache *cache,
+                       const struct LFreeCacheKey *key,
+                       double *beta,
+                       int *found)
+{
+    #pragma omp critical(lfree_cache)
+    {
+        int e = find_entry(cache, key);
+        *found = (e >= 0);
+
+        if(*found)
+        {
+            memcpy(beta, cache->entries[e].beta,
+                    key->nrays * sizeof(double));
+
+            lru_remove(cache, e);
+            lru_push_front(cache, e);
+        }
+    }
+
+    STATS_add_lfree_cache_lookup(*found);
+    return 0;
+}
+
+int LFREE_CACHE_insert(struct LFreeCache *cache,
+                       const struct LFreeCacheKey *key,
+                       const double *beta)
+{
+    int rval = 0;
+
+    struct LFreeCacheKey copy = *key;
+    double *beta_copy = 0;
+
+    copy.values = (double *) malloc(key->length * sizeof(double));
+    beta_copy = (double *) malloc(max(1, key->nrays) * sizeof(double));
+    abort_if(!copy.values, "could not allocate copy.values");
+    abort_if(!beta_copy, "could not allocate beta_copy");
+
+    memcpy(copy.values, key->values, key->length * sizeof(double));
+    memcpy(beta_copy, beta, key->nrays * sizeof(double));
+
+    #pragma omp critical(lfree_cache)
+    {
+        if(find_entry(cache, key) < 0)
+        {
+            int e;
+
+            if(cache->n_entries < cache->capacity)
+            {
+                e = cache->n_entries++;
+            }
+            else
+            {
+                e = cache->lru_last;
+                lru_remove(cache, e);
+                bucket_remove(cache, e);
+                cache->evictions++;
+            }
+
+            // Arrays of the evicted entry, if any, are freed after the
+            // critical section
+            struct LFreeCacheEntry *entry = &cache->entries[e];
+            double *old_values = entry->key.values;
+            double *old_beta = entry->beta;
+
+            entry->key = copy;
+            entry->beta = beta_copy;
+            copy.values = old_values;
+            beta_copy = old_beta;
+
+            bucket_insert(cache, e);
+            lru_push_front(cache, e);
+        }
+    }
+
+CLEANUP:
+    if(copy.values) free(copy.values);
+    if(beta_copy) free(beta_copy);
+    return rval;
+}
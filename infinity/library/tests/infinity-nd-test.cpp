@@ -32,6 +32,7 @@ const double E = 1e-6;
 TEST(InfinityNDTest, find_violated_cone_test)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     int nrows = 2;
     int nrays = 4;
@@ -51,8 +52,8 @@ TEST(InfinityNDTest, find_violated_cone_test)
     int rx[nrays];
     int found;
 
-    rval = find_violated_cone(nrows, nrays, f, rays, x, beta, 1.0, rx, sbar,
-            &found);
+    rval = find_violated_cone(nrows, nrays, f, rays, x, beta, 1.0, &stats, rx,
+            sbar, &found);
     abort_if(rval, "find_violated_cone failed");
 
     EXPECT_TRUE(found);
@@ -61,8 +62,8 @@ TEST(InfinityNDTest, find_violated_cone_test)
     EXPECT_TRUE(rx[2]);
     EXPECT_FALSE(rx[3]);
 
-    rval = find_violated_cone(nrows, nrays, f, rays, x, beta, 0.5, rx, sbar,
-            &found);
+    rval = find_violated_cone(nrows, nrays, f, rays, x, beta, 0.5, &stats, rx,
+            sbar, &found);
     abort_if(rval, "find_violated_cone failed");
 
     EXPECT_FALSE(found);
@@ -74,6 +75,7 @@ TEST(InfinityNDTest, find_violated_cone_test)
 TEST(InfinityNDTest, find_tight_rays_test_1)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double f[] = { 0.5, 0.5 };
     double rays[] =
@@ -92,7 +94,7 @@ TEST(InfinityNDTest, find_tight_rays_test_1)
 
     int tx[6];
 
-    rval = find_tight_rays(2, 6, f, rays, x, beta, epsilon, tx);
+    rval = find_tight_rays(2, 6, f, rays, x, beta, epsilon, &stats, tx);
     abort_if(rval, "find_tight_rays failed");
 
     EXPECT_TRUE(tx[0]);
@@ -109,6 +111,7 @@ TEST(InfinityNDTest, find_tight_rays_test_1)
 TEST(InfinityNDTest, find_tight_rays_test_2)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double f[] = { 0.5, 0.5 };
     double rays[] =
@@ -126,7 +129,7 @@ TEST(InfinityNDTest, find_tight_rays_test_2)
 
     int tx[6];
 
-    rval = find_tight_rays(2, 6, f, rays, x, beta, epsilon, tx);
+    rval = find_tight_rays(2, 6, f, rays, x, beta, epsilon, &stats, tx);
     abort_if(rval, "find_tight_rays failed");
 
     EXPECT_TRUE(tx[0]);
@@ -143,6 +146,7 @@ TEST(InfinityNDTest, find_tight_rays_test_2)
 TEST(InfinityNDTest, cone_bound_test_1)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double f[] = { 0.5, 0.5 };
     double rays[] =
@@ -163,11 +167,11 @@ TEST(InfinityNDTest, cone_bound_test_1)
 
     double epsilon;
 
-    rval = cone_bound(2, 6, f, rays, rx1, x, beta, &epsilon);
+    rval = cone_bound(2, 6, f, rays, rx1, x, beta, &stats, &epsilon);
     abort_if(rval, "cone_bound failed");
     EXPECT_NEAR(0.5, epsilon, E);
 
-    rval = cone_bound(2, 6, f, rays, rx2, x, beta, &epsilon);
+    rval = cone_bound(2, 6, f, rays, rx2, x, beta, &stats, &epsilon);
     abort_if(rval, "cone_bound failed");
     EXPECT_NEAR(1.0, epsilon, E);
 
@@ -178,6 +182,7 @@ TEST(InfinityNDTest, cone_bound_test_1)
 TEST(InfinityNDTest, cone_bound_test_2)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double f[] = { 0.0, 0.0 };
     double rays[] =
@@ -196,19 +201,19 @@ TEST(InfinityNDTest, cone_bound_test_2)
 
     double epsilon;
 
-    rval = cone_bound(2, 2, f, rays, rx, x1, beta1, &epsilon);
+    rval = cone_bound(2, 2, f, rays, rx, x1, beta1, &stats, &epsilon);
     abort_if(rval, "cone_bound failed");
     EXPECT_NEAR(1.0, epsilon, E);
 
-    rval = cone_bound(2, 2, f, rays, rx, x1, beta2, &epsilon);
+    rval = cone_bound(2, 2, f, rays, rx, x1, beta2, &stats, &epsilon);
     abort_if(rval, "cone_bound failed");
     EXPECT_EQ(INFINITY, epsilon);
 
-    rval = cone_bound(2, 2, f, rays, rx, x2, beta2, &epsilon);
+    rval = cone_bound(2, 2, f, rays, rx, x2, beta2, &stats, &epsilon);
     abort_if(rval, "cone_bound failed");
     EXPECT_NEAR(1.0, epsilon, E);
 
-    rval = cone_bound(2, 2, f, rays, rx, x2, beta3, &epsilon);
+    rval = cone_bound(2, 2, f, rays, rx, x2, beta3, &stats, &epsilon);
     abort_if(rval, "cone_bound failed");
     EXPECT_EQ(INFINITY, epsilon);
 
@@ -219,6 +224,7 @@ CLEANUP:
 TEST(InfinityNDTest, bound_test_1)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double f[] = { 0.5, 0.5 };
     double rays[] =
@@ -238,7 +244,7 @@ TEST(InfinityNDTest, bound_test_1)
     double epsilon;
     int tx[6];
 
-    rval = bound(2, 6, f, rays, x, beta1, &epsilon, tx);
+    rval = bound(2, 6, f, rays, x, beta1, &stats, &epsilon, tx);
     abort_if(rval, "bound failed");
     EXPECT_NEAR(epsilon, 0.5, E);
     EXPECT_TRUE(tx[0]);
@@ -248,7 +254,7 @@ TEST(InfinityNDTest, bound_test_1)
     EXPECT_FALSE(tx[4]);
     EXPECT_FALSE(tx[5]);
 
-    rval = bound(2, 6, f, rays, x, beta2, &epsilon, tx);
+    rval = bound(2, 6, f, rays, x, beta2, &stats, &epsilon, tx);
     abort_if(rval, "bound failed");
     EXPECT_NEAR(epsilon, 1.0, E);
     EXPECT_TRUE(tx[0]);
@@ -258,7 +264,7 @@ TEST(InfinityNDTest, bound_test_1)
     EXPECT_TRUE(tx[4]);
     EXPECT_TRUE(tx[5]);
 
-    rval = bound(2, 6, f, rays, x, beta3, &epsilon, tx);
+    rval = bound(2, 6, f, rays, x, beta3, &stats, &epsilon, tx);
     abort_if(rval, "bound failed");
     EXPECT_EQ(epsilon, INFINITY);
     EXPECT_FALSE(tx[0]);
@@ -418,9 +424,179 @@ CLEANUP:
     if(rval) FAIL();
 }
 
+TEST(InfinityNDTest, psi_halfspaces_test)
+{
+    int rval = 0;
+
+    double f[] = { 0.5, 0.5 };
+    double rays[] =
+    {
+         1.0,  1.0,
+         1.0, -1.0,
+        -1.0, -1.0,
+        -1.0,  1.0,
+         0.0,  1.0,
+         1.0,  0.0
+    };
+    double beta[] = { 0.5, 0.5, 0.5, 0.5, 1.0, 1.0 };
+
+    double q1[] = { 1.0, 1.0 };
+    double q2[] = { -2.0, 0.0 };
+
+    struct ConvLFreeSet lfree;
+    lfree.f = f;
+    lfree.beta = beta;
+    lfree.rays.nrays = 6;
+    lfree.rays.values = rays;
+    lfree.nrows = lfree.rays.dim = 2;
+    lfree.n_halfspaces = 0;
+    lfree.halfspaces = 0;
+
+    double value;
+
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+    EXPECT_EQ(lfree.n_halfspaces, 5);
+
+    rval = INFINITY_psi_halfspaces(2, q1, 1.0, &lfree, &value);
+    abort_if(rval, "INFINITY_psi_halfspaces failed");
+    EXPECT_NEAR(value, 2.0, E);
+
+    rval = INFINITY_psi_halfspaces(2, q2, 2.0, &lfree, &value);
+    abort_if(rval, "INFINITY_psi_halfspaces failed");
+    EXPECT_NEAR(value, 8.0, E);
+
+    // f on the boundary of the set: no closed form available
+    beta[2] = beta[3] = 0;
+
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+    EXPECT_EQ(lfree.n_halfspaces, 0);
+
+CLEANUP:
+    free(lfree.halfspaces);
+    if(rval) FAIL();
+}
+
+TEST(InfinityNDTest, conv_halfspaces_3d_test)
+{
+    int rval = 0;
+
+    // Corners of a cube, followed by the centers of its faces, which lie
+    // on the facets and must not produce extra halfspaces
+    double f[] = { 0.5, 0.5, 0.5 };
+    double rays[] =
+    {
+         1.0,  1.0,  1.0,
+         1.0,  1.0, -1.0,
+         1.0, -1.0,  1.0,
+         1.0, -1.0, -1.0,
+        -1.0,  1.0,  1.0,
+        -1.0,  1.0, -1.0,
+        -1.0, -1.0,  1.0,
+        -1.0, -1.0, -1.0,
+         1.0,  0.0,  0.0,
+        -1.0,  0.0,  0.0,
+         0.0,  1.0,  0.0,
+         0.0, -1.0,  0.0,
+         0.0,  0.0,  1.0,
+         0.0,  0.0, -1.0
+    };
+    double beta[] = { 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5,
+                      0.5, 0.5, 0.5, 0.5, 0.5, 0.5 };
+
+    double q[] = { 1.0, 0.5, 0.0 };
+
+    struct ConvLFreeSet lfree;
+    lfree.f = f;
+    lfree.beta = beta;
+    lfree.rays.nrays = 14;
+    lfree.rays.values = rays;
+    lfree.nrows = lfree.rays.dim = 3;
+    lfree.n_halfspaces = 0;
+    lfree.halfspaces = 0;
+
+    double value;
+
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+    EXPECT_EQ(lfree.n_halfspaces, 6);
+
+    for(int k = 0; k < lfree.n_halfspaces; k++)
+    {
+        double sum = 0;
+        for(int j = 0; j < 3; j++)
+            sum += fabs(lfree.halfspaces[3 * k + j]);
+        EXPECT_NEAR(sum, 2.0, E);
+    }
+
+    rval = INFINITY_psi_halfspaces(3, q, 1.0, &lfree, &value);
+    abort_if(rval, "INFINITY_psi_halfspaces failed");
+    EXPECT_NEAR(value, 2.0, E);
+
+    // f on a facet of the set: no closed form available
+    for(int i = 0; i < 14; i++)
+        if(rays[3 * i] < 0) beta[i] = 0;
+
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+    EXPECT_EQ(lfree.n_halfspaces, 0);
+
+CLEANUP:
+    free(lfree.halfspaces);
+    if(rval) FAIL();
+}
+
+TEST(InfinityNDTest, pi_halfspaces_test)
+{
+    int rval = 0;
+
+    double f[] = { 0.5, 0.5 };
+    double rays[] =
+    {
+         1.0,  1.0,
+         1.0, -1.0,
+        -1.0, -1.0,
+        -1.0,  1.0,
+         0.0,  1.0,
+         1.0,  0.0
+    };
+    double beta[] = { 0.5, 0.5, 0.5, 0.5, 1.0, 1.0 };
+
+    double q1[] = { 1.75, -0.5 };
+    double q2[] = { 0.25, 0.25 };
+
+    struct ConvLFreeSet lfree;
+    lfree.f = f;
+    lfree.beta = beta;
+    lfree.rays.nrays = 6;
+    lfree.rays.values = rays;
+    lfree.nrows = lfree.rays.dim = 2;
+    lfree.n_halfspaces = 0;
+    lfree.halfspaces = 0;
+
+    double value;
+
+    rval = LFREE_compute_conv_halfspaces(&lfree);
+    abort_if(rval, "LFREE_compute_conv_halfspaces failed");
+
+    rval = INFINITY_pi_halfspaces(2, q1, 1.0, &lfree, &value);
+    abort_if(rval, "INFINITY_pi_halfspaces failed");
+    EXPECT_NEAR(value, 0.75, E);
+
+    rval = INFINITY_pi_halfspaces(2, q2, 3.0, &lfree, &value);
+    abort_if(rval, "INFINITY_pi_halfspaces failed");
+    EXPECT_NEAR(value, 0.5, E);
+
+CLEANUP:
+    free(lfree.halfspaces);
+    if(rval) FAIL();
+}
+
 TEST(DISABLED_InfinityNDTest, generate_cut_test_1)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double r0[] = {  1.0,  1.0 };
     double r1[] = {  1.0, -1.0 };
@@ -443,7 +619,7 @@ TEST(DISABLED_InfinityNDTest, generate_cut_test_1)
     struct ConvLFreeSet lfree;
     LFREE_init_conv(&lfree, 2, 6);
 
-    rval = INFINITY_ND_generate_lfree(&model, &lfree);
+    rval = INFINITY_ND_generate_lfree(&model, &lfree, &stats);
     abort_if(rval, "INFINITY_ND_generate_lfree failed");
 
     EXPECT_NEAR(lfree.beta[0], 0.5, E);
@@ -460,6 +636,7 @@ CLEANUP:
 TEST(InfinityNDTest, generate_cut_test_2)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double r0[] = { 1.0,  0.0,  0.0 };
     double r1[] = {-1.0,  0.0,  0.0 };
@@ -483,7 +660,7 @@ TEST(InfinityNDTest, generate_cut_test_2)
     struct ConvLFreeSet lfree;
     LFREE_init_conv(&lfree, 3, 6);
 
-    rval = INFINITY_ND_generate_lfree(&model, &lfree);
+    rval = INFINITY_ND_generate_lfree(&model, &lfree, &stats);
     abort_if(rval, "INFINITY_ND_generate_lfree failed");
 
     EXPECT_NEAR(lfree.beta[0], 0.75, E);
@@ -501,6 +678,7 @@ CLEANUP:
 TEST(InfinityNDTest, scale_to_ahull_test)
 {
     int rval = 0;
+    struct InfinityStats stats = {0};
 
     double rays[] = 
     {
@@ -520,15 +698,15 @@ TEST(InfinityNDTest, scale_to_ahull_test)
 
     double alpha;
 
-    rval = scale_to_ahull(3, 4, rays, rx, beta, epsilon, d1, &alpha);
+    rval = scale_to_ahull(3, 4, rays, rx, beta, epsilon, d1, &stats, &alpha);
     abort_if(rval, "scale_to_ahull failed");
     EXPECT_DOUBLE_EQ(1 / 3.0, alpha);
 
-    rval = scale_to_ahull(3, 4, rays, rx, beta, epsilon, d2, &alpha);
+    rval = scale_to_ahull(3, 4, rays, rx, beta, epsilon, d2, &stats, &alpha);
     abort_if(rval, "scale_to_ahull failed");
     EXPECT_DOUBLE_EQ(0.25, alpha);
 
-    rval = scale_to_ahull(3, 4, rays, rx, beta, epsilon, d3, &alpha);
+    rval = scale_to_ahull(3, 4, rays, rx, beta, epsilon, d3, &stats, &alpha);
     abort_if(rval, "scale_to_ahull failed");
     EXPECT_EQ(INFINITY, alpha);
 
@@ -536,6 +714,47 @@ CLEANUP:
     if(rval) FAIL();
 }
 
+TEST(InfinityNDTest, find_interior_point_enum_test)
+{
+    int rval = 0;
+
+    int nrows = 4;
+    int nrays = 5;
+    double f[] = { 0.5, 0.5, 0.5, 0.5 };
+    double rays[] =
+    {
+         1.0,  0.0,  0.0,  0.0,
+         0.0,  1.0,  0.0,  0.0,
+         0.0,  0.0,  1.0,  0.0,
+         0.0,  0.0,  0.0,  1.0,
+        -1.0, -1.0, -1.0, -1.0
+    };
+
+    double beta1[] = { 6.0, 6.0, 6.0, 6.0, 6.0 };
+    double beta2[] = { 0.4, 0.4, 0.4, 0.4, 0.4 };
+    double epsilon = 100.0;
+
+    double x[4];
+    int found;
+
+    rval = find_interior_point_enum(nrows, nrays, f, rays, beta1, epsilon, x,
+            &found);
+    abort_if(rval, "find_interior_point_enum failed");
+    EXPECT_TRUE(found);
+    EXPECT_DOUBLE_EQ(0.0, x[0]);
+    EXPECT_DOUBLE_EQ(0.0, x[1]);
+    EXPECT_DOUBLE_EQ(0.0, x[2]);
+    EXPECT_DOUBLE_EQ(0.0, x[3]);
+
+    rval = find_interior_point_enum(nrows, nrays, f, rays, beta2, epsilon, x,
+            &found);
+    abort_if(rval, "find_interior_point_enum failed");
+    EXPECT_FALSE(found);
+
+CLEANUP:
+    if(rval) FAIL();
+}
+
 TEST(InfinityNDTest, cone_bound_find_lambda_test)
 {
     int rval = 0;
@@ -15,6 +15,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <omp.h>
 
 #define TEST_SOURCE
 
@@ -26,8 +27,112 @@ extern "C" {
 int ENABLE_LIFTING = 0;
 int MIN_N_ROWS = 2;
 int MAX_N_ROWS = 2;
-int SHOULD_DUMP_CUTS = 1;
-int DUMP_CUT_N = 0;
+int N_THREADS = 1;
+int CUT_POOL_SIZE = 0;
+int CUT_BATCH_SIZE = 1;
+int CUT_SELECTION = CUT_SELECTION_VIOLATION;
+int TABLEAU_ENGINE = TABLEAU_ENGINE_CPLEX;
+int LFREE_2D_ALGORITHM = LFREE_2D_ALGORITHM_FAST;
+
+static int create_reversed_tableau(const struct Tableau *tableau,
+                                   struct Tableau *reversed)
+{
+    int rval = 0;
+    int ncols = tableau->ncols;
+
+    reversed->ncols = ncols;
+    reversed->nrows = tableau->nrows;
+    reversed->rows = (struct Row **) calloc(tableau->nrows,
+            sizeof(struct Row *));
+    reversed->column_types = (char *) malloc(ncols * sizeof(char));
+    abort_if(!reversed->rows, "could not allocate reversed->rows");
+    abort_if(!reversed->column_types, "could not allocate column_types");
+
+    for(int j = 0; j < ncols; j++)
+        reversed->column_types[j] = tableau->column_types[ncols - j - 1];
+
+    for(int i = 0; i < tableau->nrows; i++)
+    {
+        const struct Row *row = tableau->rows[i];
+        struct Row *rev = (struct Row *) malloc(sizeof(struct Row));
+        abort_if(!rev, "could not allocate rev");
+
+        rval = LP_init_row(rev, row->nz);
+        abort_if(rval, "LP_init_row failed");
+
+        rev->nz = row->nz;
+        rev->head = ncols - row->head - 1;
+        rev->pi_zero = row->pi_zero;
+
+        for(int k = 0; k < row->nz; k++)
+        {
+            rev->pi[k] = row->pi[row->nz - k - 1];
+            rev->indices[k] = ncols - row->indices[row->nz - k - 1] - 1;
+        }
+
+        reversed->rows[i] = rev;
+    }
+
+CLEANUP:
+    return rval;
+}
+
+static void free_reversed_tableau(struct Tableau *reversed)
+{
+    if(!reversed->rows) return;
+
+    for(int i = 0; i < reversed->nrows; i++)
+    {
+        if(!reversed->rows[i]) continue;
+        LP_free_row(reversed->rows[i]);
+        free(reversed->rows[i]);
+    }
+
+    free(reversed->rows);
+    free(reversed->column_types);
+}
+
+/*
+ * Generates one cut for each given tableau, using n_threads threads that
+ * share a single lattice-free set cache.
+ */
+static int generate_cuts_shared_cache(const struct Tableau **tableaus,
+                                      int n_tableaus,
+                                      int n_threads,
+                                      struct Row *cuts)
+{
+    int rval = 0;
+    struct LFreeCache cache;
+    struct InfinityContext contexts[4];
+
+    rval = LFREE_CACHE_init(&cache, 100);
+    abort_if(rval, "LFREE_CACHE_init failed");
+
+    for(int t = 0; t < n_threads; t++)
+    {
+        INFINITY_init_context(&contexts[t], t);
+        contexts[t].cache = &cache;
+    }
+
+    #pragma omp parallel for num_threads(n_threads) schedule(dynamic)
+    for(int k = 0; k < n_tableaus; k++)
+    {
+        int r = INFINITY_generate_cut(tableaus[k],
+                &contexts[omp_get_thread_num()], &cuts[k]);
+
+        if(r)
+        {
+            #pragma omp atomic write
+            rval = r;
+        }
+    }
+
+    abort_if(rval, "INFINITY_generate_cut failed");
+
+CLEANUP:
+    LFREE_CACHE_free(&cache);
+    return rval;
+}
 
 TEST(InfinityTest, cmp_ray_angle_test)
 {
@@ -148,7 +253,10 @@ TEST(InfinityTest, generate_cut_test)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
     lhs = CG_replace_x(&cut, x);
@@ -178,7 +286,10 @@ TEST(InfinityTest, generate_cut_test_2)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
     lhs = CG_replace_x(&cut, x);
@@ -207,7 +318,10 @@ TEST(InfinityTest, generate_cut_test_3)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
     lhs = CG_replace_x(&cut, x);
@@ -243,7 +357,10 @@ TEST(InfinityTest, generate_cut_test_4)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
     rval = get_lattice_point(&tableau, x, s);
@@ -329,7 +446,10 @@ TEST(InfinityTest, generate_cut_test_5)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
     rval = get_lattice_point(&tableau, x, s);
@@ -363,7 +483,10 @@ TEST(InfinityTest, generate_cut_test_6)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -391,7 +514,10 @@ TEST(InfinityTest, generate_cut_test_7)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -416,7 +542,10 @@ TEST(InfinityTest, generate_cut_test_8)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -441,7 +570,10 @@ TEST(InfinityTest, generate_cut_test_9)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -469,7 +601,10 @@ TEST(InfinityTest, generate_cut_test_10)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -497,7 +632,10 @@ TEST(InfinityTest, generate_cut_test_11)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -525,7 +663,10 @@ TEST(InfinityTest, generate_cut_test_12)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
 CLEANUP:
@@ -555,7 +696,10 @@ TEST(InfinityTest, generate_cut_test_13)
     struct Row cut;
     LP_init_row(&cut, CG_total_nz(&tableau));
 
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
 
     rval = get_lattice_point(&tableau, x, s);
@@ -592,7 +736,10 @@ TEST(DISABLED_InfinityTest, generate_cut_test_14)
     LP_init_row(&cut, CG_total_nz(&tableau));
 
     ENABLE_LIFTING = 1;
-    rval = INFINITY_generate_cut(&tableau, &cut);
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_generate_cut(&tableau, &ctx, &cut);
     abort_if(rval, "INFINITY_generate_cut failed");
     ENABLE_LIFTING = 0;
 
@@ -608,4 +755,108 @@ TEST(DISABLED_InfinityTest, generate_cut_test_14)
 
 CLEANUP:
     if (rval) FAIL();
-}
\ No newline at end of file
+}
+
+TEST(InfinityTest, generate_lfree_fallback_test)
+{
+    int rval = 0;
+
+    // Nearly horizontal rays: the 2D lattice search would have to visit
+    // more than MAX_LATTICE_POINTS points
+    double f[] = { 0.5, 0.5 };
+    double rays[] = {
+            1.0, 0.001,
+            -1.0, 0.001,
+            0.0, -1.0
+    };
+
+    const struct MultiRowModel model = {f, rays, 3, 2};
+
+    struct ConvLFreeSet lfree;
+    LFREE_init_conv(&lfree, 2, 3);
+
+    struct InfinityContext ctx;
+    INFINITY_init_context(&ctx, 0);
+
+    rval = INFINITY_2D_generate_lfree(&model, &lfree);
+    EXPECT_EQ(ERR_MIP_TIMEOUT, rval);
+
+    rval = generate_lfree(&model, &ctx, &lfree);
+    abort_if(rval, "generate_lfree failed");
+
+    for(int i = 0; i < 3; i++)
+    {
+        EXPECT_GT(lfree.beta[i], 0);
+        EXPECT_LE(lfree.beta[i], INFINITY_BIG_E);
+    }
+
+CLEANUP:
+    LFREE_free_conv(&lfree);
+    if (rval) FAIL();
+}
+
+TEST(InfinityTest, generate_cut_threads_test)
+{
+    int rval = 0;
+
+    // Extracted from instance bell5.pre.mps (MIPLIB 3)
+    double pi0[] = { 0.0161105463, 0.0161105463, 0.0161105463, 0.0161105463, -0.0161105463, -0.0161105463, 0.0250000000, 0.0322210925, 0.0322210925, 0.0322210925, 0.0322210925, 0.0051991866, 0.0051991866, 0.0051991866, 0.0051991866, 0.0057745633, 0.0057745633, 0.0057745633, -0.0002166328, -0.0000239740, -0.0000611764, -0.0002406068, -0.0000239740, -0.0000611764, -0.0000239740, -0.0000239740, -0.0000239740, -0.2888437009, -0.2888437009, -0.2888437009, -0.2888437009, 0.3555781496, 1.0000000000, -0.0322210925, -0.0322210925, 0.0500000000, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, 0.0000372024, -0.0002166328, -0.0002166328, -0.0002166328, -0.0002166328, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0000239740, -0.0000239740, -0.0002406068, -0.0002406068, -0.2888437009, };
+    double pi1[] = { 1.0000000000, -0.0250000000, 0.0000372024, 0.0000372024, -0.0500000000, -0.0000372024, };
+    double pi2[] = { 1.0000000000, 0.0161105463, 0.0161105463, 0.0161105463, 0.0161105463, -0.0161105463, -0.0161105463, 0.0322210925, 0.0322210925, 0.0322210925, 0.0322210925, 0.0051991866, 0.0051991866, 0.0051991866, 0.0051991866, 0.0057745633, 0.0057745633, 0.0057745633, -0.0002166328, -0.0000239740, -0.0000239740, -0.0002406068, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -1.2888437009, -1.2888437009, -1.2888437009, -1.2888437009, -0.6444218504, -0.0322210925, -0.0322210925, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -0.0000239740, -0.0002166328, -0.0002166328, -0.0002166328, -0.0002166328, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0002406068, -0.0000239740, -0.0000239740, -0.0002406068, -0.0002406068, -0.2888437009, };
+    int indices0[] = { 12, 13, 14, 15, 16, 18, 19, 26, 27, 28, 29, 40, 41, 42, 43, 51, 52, 53, 58, 59, 61, 62, 72, 74, 75, 78, 80, 94, 95, 96, 97, 99, 100, 109, 111, 112, 119, 120, 121, 122, 123, 125, 126, 133, 134, 135, 136, 144, 145, 146, 147, 148, 149, 150, 151, 153, 157, 158, 159, };
+    int indices1[] = { 7, 19, 61, 74, 112, 126, };
+    int indices2[] = { 0, 12, 13, 14, 15, 16, 18, 26, 27, 28, 29, 40, 41, 42, 43, 51, 52, 53, 58, 59, 61, 62, 72, 74, 75, 78, 80, 94, 95, 96, 97, 99, 109, 111, 119, 120, 121, 122, 123, 125, 133, 134, 135, 136, 144, 145, 146, 147, 148, 149, 150, 151, 153, 157, 158, 159, };
+    struct Row row0 = {.nz = 59, .head = 100, .pi_zero = 0.0040117914, .pi = pi0, .indices = indices0 };
+    struct Row row1 = {.nz = 6, .head = 7, .pi_zero = 0.1116071429, .pi = pi1, .indices = indices1 };
+    struct Row row2 = {.nz = 56, .head = 0, .pi_zero = 0.1156189343, .pi = pi2, .indices = indices2 };
+    struct Row* rows[] = {&row0, &row1, &row2, };
+    char column_types[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, };
+    struct Tableau tableau = {.ncols = 169, .nrows = 3, .rows = rows, .column_types = column_types };
+
+    struct Tableau reversed = {0};
+
+    const int n_tableaus = 8;
+    const struct Tableau *tableaus[n_tableaus];
+    struct Row cuts1[n_tableaus];
+    struct Row cuts4[n_tableaus];
+
+    // Models of the reversed tableau have the same rays as the original
+    // ones, in a different order
+    rval = create_reversed_tableau(&tableau, &reversed);
+    abort_if(rval, "create_reversed_tableau failed");
+
+    for(int k = 0; k < n_tableaus; k++)
+    {
+        tableaus[k] = (k % 2 ? &reversed : &tableau);
+        LP_init_row(&cuts1[k], CG_total_nz(&tableau));
+        LP_init_row(&cuts4[k], CG_total_nz(&tableau));
+    }
+
+    rval = generate_cuts_shared_cache(tableaus, n_tableaus, 1, cuts1);
+    abort_if(rval, "generate_cuts_shared_cache failed");
+
+    rval = generate_cuts_shared_cache(tableaus, n_tableaus, 4, cuts4);
+    abort_if(rval, "generate_cuts_shared_cache failed");
+
+    for(int k = 0; k < n_tableaus; k++)
+    {
+        EXPECT_EQ(cuts1[k].nz, cuts4[k].nz);
+        EXPECT_EQ(cuts1[k].pi_zero, cuts4[k].pi_zero);
+
+        for(int j = 0; j < min(cuts1[k].nz, cuts4[k].nz); j++)
+        {
+            EXPECT_EQ(cuts1[k].indices[j], cuts4[k].indices[j]);
+            EXPECT_EQ(cuts1[k].pi[j], cuts4[k].pi[j]);
+        }
+    }
+
+    for(int k = 0; k < n_tableaus; k++)
+    {
+        LP_free_row(&cuts1[k]);
+        LP_free_row(&cuts4[k]);
+    }
+
+CLEANUP:
+    free_reversed_tableau(&reversed);
+    if (rval) FAIL();
+}
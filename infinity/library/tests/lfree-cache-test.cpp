@@ -0,0 +1,185 @@
+/* Copyright (c) 2015 Alinson Xavier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <multirow/util.h>
+#include <infinity/lfree-cache.h>
+}
+
+static int create_model(double f0,
+                        const double *rays,
+                        int nrays,
+                        struct MultiRowModel *model)
+{
+    int rval = 0;
+
+    rval = CG_init_model(model, 2, nrays);
+    abort_if(rval, "CG_init_model failed");
+
+    model->f[0] = f0;
+    model->f[1] = 0.5;
+
+    for(int i = 0; i < nrays; i++)
+        LFREE_push_ray(&model->rays, &rays[2 * i]);
+
+CLEANUP:
+    return rval;
+}
+
+TEST(LFreeCacheTest, lookup_test)
+{
+    int rval = 0;
+    int found;
+
+    double rays1[] = { 1.0, 0.0, 0.0, 1.0, -1.0, -1.0 };
+    double rays2[] = { -1.0, -1.0, 1.0, 0.0, 0.0, 1.0 };
+    double rays3[] = { 1.0, 0.0, 0.0, 1.0, -1.0, -0.5 };
+    double rays4[] = { 1.0, 0.0, 0.0, 1.0, -1.0, -1.0 };
+    double beta1[] = { 1.0, 2.0, 3.0 };
+    double beta[3];
+
+    struct MultiRowModel model1, model2, model3, model4;
+    struct LFreeCacheKey key1, key2, key3, key4;
+    struct LFreeCache cache;
+
+    rval = LFREE_CACHE_init(&cache, 10);
+    abort_if(rval, "LFREE_CACHE_init failed");
+
+    rval = create_model(0.5, rays1, 3, &model1);
+    abort_if(rval, "create_model failed");
+
+    rval = create_model(0.5, rays2, 3, &model2);
+    abort_if(rval, "create_model failed");
+
+    rval = create_model(0.5, rays3, 3, &model3);
+    abort_if(rval, "create_model failed");
+
+    rval = create_model(0.5, rays4, 3, &model4);
+    abort_if(rval, "create_model failed");
+
+    rval = LFREE_CACHE_init_key(&model1, &key1);
+    abort_if(rval, "LFREE_CACHE_init_key failed");
+
+    rval = LFREE_CACHE_init_key(&model2, &key2);
+    abort_if(rval, "LFREE_CACHE_init_key failed");
+
+    rval = LFREE_CACHE_init_key(&model3, &key3);
+    abort_if(rval, "LFREE_CACHE_init_key failed");
+
+    rval = LFREE_CACHE_init_key(&model4, &key4);
+    abort_if(rval, "LFREE_CACHE_init_key failed");
+
+    rval = LFREE_CACHE_lookup(&cache, &key1, beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_FALSE(found);
+
+    rval = LFREE_CACHE_insert(&cache, &key1, beta1);
+    abort_if(rval, "LFREE_CACHE_insert failed");
+
+    rval = LFREE_CACHE_lookup(&cache, &key4, beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_TRUE(found);
+    EXPECT_EQ(beta[0], 1.0);
+    EXPECT_EQ(beta[1], 2.0);
+    EXPECT_EQ(beta[2], 3.0);
+
+    // Same rays in a different order
+    rval = LFREE_CACHE_lookup(&cache, &key2, beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_FALSE(found);
+
+    rval = LFREE_CACHE_lookup(&cache, &key3, beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_FALSE(found);
+
+    LFREE_CACHE_free_key(&key1);
+    LFREE_CACHE_free_key(&key2);
+    LFREE_CACHE_free_key(&key3);
+    LFREE_CACHE_free_key(&key4);
+    CG_free_model(&model1);
+    CG_free_model(&model2);
+    CG_free_model(&model3);
+    CG_free_model(&model4);
+    LFREE_CACHE_free(&cache);
+
+CLEANUP:
+    if(rval) FAIL();
+}
+
+TEST(LFreeCacheTest, eviction_test)
+{
+    int rval = 0;
+    int found;
+
+    double rays[] = { 1.0, 0.0, 0.0, 1.0, -1.0, -1.0 };
+    double beta0[] = { 1.0, 1.0, 1.0 };
+    double beta[3];
+
+    struct MultiRowModel models[3];
+    struct LFreeCacheKey keys[3];
+    struct LFreeCache cache;
+
+    rval = LFREE_CACHE_init(&cache, 2);
+    abort_if(rval, "LFREE_CACHE_init failed");
+
+    for(int i = 0; i < 3; i++)
+    {
+        rval = create_model(0.1 * (i + 1), rays, 3, &models[i]);
+        abort_if(rval, "create_model failed");
+
+        rval = LFREE_CACHE_init_key(&models[i], &keys[i]);
+        abort_if(rval, "LFREE_CACHE_init_key failed");
+    }
+
+    rval = LFREE_CACHE_insert(&cache, &keys[0], beta0);
+    abort_if(rval, "LFREE_CACHE_insert failed");
+
+    rval = LFREE_CACHE_insert(&cache, &keys[1], beta0);
+    abort_if(rval, "LFREE_CACHE_insert failed");
+
+    // Makes the first set the most recently used one
+    rval = LFREE_CACHE_lookup(&cache, &keys[0], beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_TRUE(found);
+
+    rval = LFREE_CACHE_insert(&cache, &keys[2], beta0);
+    abort_if(rval, "LFREE_CACHE_insert failed");
+    EXPECT_EQ(cache.evictions, 1);
+
+    rval = LFREE_CACHE_lookup(&cache, &keys[0], beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_TRUE(found);
+
+    rval = LFREE_CACHE_lookup(&cache, &keys[1], beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_FALSE(found);
+
+    rval = LFREE_CACHE_lookup(&cache, &keys[2], beta, &found);
+    abort_if(rval, "LFREE_CACHE_lookup failed");
+    EXPECT_TRUE(found);
+
+    for(int i = 0; i < 3; i++)
+    {
+        LFREE_CACHE_free_key(&keys[i]);
+        CG_free_model(&models[i]);
+    }
+    LFREE_CACHE_free(&cache);
+
+CLEANUP:
+    if(rval) FAIL();
+}
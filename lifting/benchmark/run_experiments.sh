@@ -23,7 +23,7 @@ SEED=1240
 # ------------------------------------------------------------------------------
 
 ANSWERS="answers/orig-$SEED.txt"
-COMMON_OPTS="--seed $SEED --sets $INSTANCES"
+COMMON_OPTS="--seed $SEED --sets $INSTANCES --max-sets 1000"
 
 title Generating answers
 $RUN $COMMON_OPTS --bound --write-answers $ANSWERS || exit
@@ -51,6 +51,12 @@ $RUN $COMMON_OPTS --samples 100 --naive --fixed-bounds $M --log $DIR/naive-fixed
 title Naive Bounding-Box Pre-processing
 $RUN $COMMON_OPTS --samples 100 --naive --preprocess --log $DIR/naive-bbox-pre.log --stats $DIR/naive-bbox-pre.yaml || exit
 
+title Table
+$RUN $COMMON_OPTS --samples 1000 --table --log $DIR/table.log --stats $DIR/table.yaml || exit
+
+title Table Pre-processing
+$RUN $COMMON_OPTS --samples 1000 --table --preprocess --log $DIR/table-pre.log --stats $DIR/table-pre.yaml || exit
+
 title MIP
 $RUN $COMMON_OPTS --samples 10 --mip --log $DIR/mip.log --stats $DIR/mip.yaml || exit
 
@@ -61,7 +67,7 @@ $RUN $COMMON_OPTS --samples 10 --mip --preprocess --log $DIR/mip-pre.log --stats
 # ------------------------------------------------------------------------------
 
 ANSWERS=answers/shear-$SEED.txt
-COMMON_OPTS="--shear --seed $SEED --sets $INSTANCES"
+COMMON_OPTS="--shear --seed $SEED --sets $INSTANCES --max-sets 1000"
 
 title Generating answers
 $RUN $COMMON_OPTS --bound --write-answers $ANSWERS || exit
@@ -86,6 +92,12 @@ title Naive Fixed-M + Shear
 M=50
 $RUN $COMMON_OPTS --samples 100 --naive --fixed-bounds $M --log $DIR/naive-fixed-$M.log --stats $DIR/naive-fixed-$M.yaml || exit
 
+title Table + Shear
+$RUN $COMMON_OPTS --samples 1000 --table --log $DIR/table.log --stats $DIR/table.yaml || exit
+
+title Table Pre-processing + Shear
+$RUN $COMMON_OPTS --samples 1000 --table --preprocess --log $DIR/table-pre.log --stats $DIR/table-pre.yaml || exit
+
 title MIP + Shear
 $RUN $COMMON_OPTS --samples 10 --mip --log $DIR/mip.log --stats $DIR/mip.yaml || exit
 
@@ -24,28 +24,37 @@
 #include <sys/time.h>
 #include <math.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include <multirow/util.h>
 #include <multirow/double.h>
 #include <multirow/lfree2d.h>
+#include <multirow/lp.h>
 #include <lifting/lifting.h>
 #include <lifting/lifting-mip.h>
+#include <lifting/lifting-table.h>
 
 char LOG_FILENAME[1000] = {0};
 char STATS_FILENAME[1000] = {0};
 char SETS_FILENAME[1000] = {0};
 char ANSWERS_FILENAME[1000] = {0};
 unsigned int SEED = 0;
+int N_THREADS = 1;
 
 #define ALGORITHM_BOUND 0
 #define ALGORITHM_NAIVE 1
 #define ALGORITHM_MIP 2
 #define ALGORITHM_HEUR 3
+#define ALGORITHM_TABLE 4
+
+#define OPTION_THREADS 1000
+#define OPTION_MAX_SETS 1001
 
 int SELECT_NAIVE_ALGORITHM = 0;
 int SELECT_BOUND_ALGORITHM = 0;
 int SELECT_MIP_ALGORITHM = 0;
 int SELECT_HEUR_ALGORITHM = 0;
+int SELECT_TABLE_ALGORITHM = 0;
 
 int ENABLE_PREPROCESSING = 0;
 int ENABLE_SHEAR = 0;
@@ -56,12 +65,7 @@ int WRITE_ANSWERS = 0;
 int USE_FIXED_BOUNDS = 0;
 int NAIVE_BIG_M = 0;
 int N_SAMPLES_PER_SET = 10;
-
-int N_ANSWERS = 0;
-double ANSWERS[100000];
-
-double PRE_M[100000];
-double CENTER[100000];
+int MAX_SETS = 0;
 
 FILE *LOG_FILE;
 FILE *STATS_FILE;
@@ -86,6 +90,9 @@ static const struct option options_tab[] =
     {"samples", required_argument, 0, 'a'},
     {"mip", no_argument, 0, 'm'},
     {"heuristic", no_argument, 0, 'r'},
+    {"table", no_argument, 0, 't'},
+    {"threads", required_argument, 0, OPTION_THREADS},
+    {"max-sets", required_argument, 0, OPTION_MAX_SETS},
     {0, 0, 0, 0}
 };
 
@@ -113,6 +120,8 @@ static void print_usage(char **argv)
             "select bound algorithm");
     printf("%4s %-20s %s\n", "-e", "--heuristic",
             "select heuristic algorithm");
+    printf("%4s %-20s %s\n", "-t", "--table",
+            "select lifting table algorithm");
     printf("%4s %-20s %s\n", "-p", "--preprocess",
             "enable pre-processing step in bound algorithm");
     printf("%4s %-20s %s\n", "-e", "--shear",
@@ -123,6 +132,10 @@ static void print_usage(char **argv)
             "check computed coefficients against given file");
     printf("%4s %-20s %s\n", "-a", "--samples=NUM",
             "use specified number of samples per set");
+    printf("%4s %-20s %s\n", "", "--threads=NUM",
+            "number of threads used to process the sets");
+    printf("%4s %-20s %s\n", "", "--max-sets=NUM",
+            "only read the first NUM valid sets");
 }
 
 void stats_printf(const char *fmt,
@@ -149,7 +162,7 @@ static int parse_args(int argc,
     {
         int c = 0;
         int option_index = 0;
-        c = getopt_long(argc, argv, "hb:k:s:f:o:nupew:c:a:mr", options_tab,
+        c = getopt_long(argc, argv, "hb:k:s:f:o:nupew:c:a:mrt", options_tab,
                         &option_index);
 
         if (c < 0) break;
@@ -217,6 +230,26 @@ static int parse_args(int argc,
             SELECT_HEUR_ALGORITHM = 1;
             break;
 
+        case 't':
+            SELECT_TABLE_ALGORITHM = 1;
+            break;
+
+        case OPTION_THREADS:
+        {
+            int count = sscanf(optarg, "%d", &N_THREADS);
+            abort_if(count != 1, "invalid number of threads");
+            abort_if(N_THREADS <= 0, "invalid number of threads");
+            break;
+        }
+
+        case OPTION_MAX_SETS:
+        {
+            int count = sscanf(optarg, "%d", &MAX_SETS);
+            abort_if(count != 1, "invalid number of sets");
+            abort_if(MAX_SETS <= 0, "invalid number of sets");
+            break;
+        }
+
         case 'p':
             ENABLE_PREPROCESSING = 1;
             break;
@@ -253,7 +286,7 @@ static int parse_args(int argc,
     }
 
     if (SELECT_NAIVE_ALGORITHM + SELECT_BOUND_ALGORITHM + SELECT_MIP_ALGORITHM
-            + SELECT_HEUR_ALGORITHM != 1)
+            + SELECT_HEUR_ALGORITHM + SELECT_TABLE_ALGORITHM != 1)
     {
         fprintf(stderr, "You must select exactly one algorithm.\n");
         rval = 1;
@@ -296,6 +329,104 @@ void print_header(int argc,
     time_printf("    %s\n", cmdline);
 }
 
+static int lift_ray(int algorithm,
+                    const struct LFreeSet2D *set,
+                    struct LiftingMIP *mip,
+                    const struct LiftingTable *table,
+                    const int *lb,
+                    const int *ub,
+                    const double *ray,
+                    double *value)
+{
+    int rval = 0;
+
+    switch (algorithm)
+    {
+        case ALGORITHM_NAIVE:
+            rval = LIFTING_2D_naive(set->n_halfspaces, set->halfspaces, ray,
+                    lb, ub, value);
+            abort_if(rval, "LIFTING_2D_naive failed");
+            break;
+
+        case ALGORITHM_MIP:
+            rval = LIFTING_2D_mip_solve(mip, ray, value);
+            abort_if(rval, "LIFTING_2D_mip_solve failed");
+            break;
+
+        case ALGORITHM_HEUR:
+            rval = LIFTING_2D_heur(set->n_halfspaces, set->halfspaces, ray,
+                    value);
+            abort_if(rval, "LIFTING_2D_heur failed");
+            break;
+
+        case ALGORITHM_TABLE:
+            rval = LIFTING_2D_table_query(table, ray, value);
+            abort_if(rval, "LIFTING_2D_table_query failed");
+            break;
+
+        default:
+            abort_if(1, "Invalid algorithm");
+    }
+
+CLEANUP:
+    return rval;
+}
+
+/**
+ * Writes the coefficients computed for the given set to the answers file,
+ * or compares them against the ones read from it.
+ */
+int check_answers(int set_idx,
+                  const double *values,
+                  int *wrong_answer)
+{
+    int rval = 0;
+
+    *wrong_answer = 0;
+
+    for (int i = 0; i < N_RAYS; i++)
+    {
+        double value = values[i];
+
+        if(WRITE_ANSWERS)
+        {
+            abort_iff(!DOUBLE_geq(value, 0),
+                    "value should be non-negative (%.8lf)", value);
+            fprintf(ANSWERS_FILE, "%d %d %.20lf\n", set_idx, i, value);
+        }
+
+        if(CHECK_ANSWERS)
+        {
+            int count;
+            int expected_set_idx, expected_i;
+            double expected_value;
+
+            while(1)
+            {
+                count = fscanf(ANSWERS_FILE, "%d %d %lf ",
+                        &expected_set_idx, &expected_i, &expected_value);
+
+                abort_if(count != 3, "error reading answer");
+                if(set_idx == expected_set_idx && i == expected_i) break;
+            }
+
+            double delta = fabs(value - expected_value);
+            if(delta > 1e-3)
+            {
+                log_warn("    wrong answer (set=%d ray=%d answer=%.8lf"
+                        " expected=%.8lf delta=%.8lf)\n", set_idx,
+                        i, value, expected_value, delta);
+                *wrong_answer = 1;
+            }
+        }
+
+        log_verbose("       %4d %12.8lf\n", i, value);
+    }
+
+CLEANUP:
+    return rval;
+}
+
 int benchmark_set_sample(int algorithm,
                          int set_idx,
                          const struct LFreeSet2D *set,
@@ -305,108 +436,92 @@ int benchmark_set_sample(int algorithm,
                          int *lb,
                          int *ub,
                          int current_sample,
-                         int *wrong_answer)
+                         double *values,
+                         double *build_time,
+                         double *query_time)
 {
     int rval = 0;
-    double xi_plus, xi_minus, ignored;
+    struct LiftingMIP mip = {0};
+    struct LiftingTable table = {0};
+    double initial_time;
+    double rays_x[N_RAYS], rays_y[N_RAYS];
 
-    if(algorithm == ALGORITHM_BOUND)
+    if(algorithm == ALGORITHM_MIP)
+    {
+        rval = LIFTING_2D_mip_create(&mip, set->n_halfspaces,
+                set->halfspaces);
+        abort_if(rval, "LIFTING_2D_mip_create failed");
+    }
+
+    if(algorithm == ALGORITHM_TABLE)
     {
-        rval = LIFTING_2D_optimize_continuous(set->n_halfspaces,
-                set->halfspaces, 1, &ignored, &xi_plus);
-        abort_if(rval, "LIFTING_2D_optimize_continuous failed");
+        initial_time = get_thread_time();
+
+        rval = LIFTING_2D_table_build(set->n_halfspaces, set->halfspaces,
+                LIFTING_TABLE_DEPTH, &table);
+
+        if(rval == ERR_TABLE_TOO_LARGE)
+        {
+            if(current_sample == 0)
+                log_warn("    lifting table is too large; using bound "
+                        "algorithm instead\n");
+
+            algorithm = ALGORITHM_BOUND;
+            rval = 0;
+        }
 
-        rval = LIFTING_2D_optimize_continuous(set->n_halfspaces,
-                set->halfspaces, -1, &ignored, &xi_minus);
-        abort_if(rval, "LIFTING_2D_optimize_continuous failed");
+        abort_if(rval, "LIFTING_2D_table_build failed");
+
+        *build_time += get_thread_time() - initial_time;
     }
 
+    initial_time = get_thread_time();
+
     for (int i = 0; i < N_RAYS; i++)
     {
-        double ray[2] = { rays[2 * i], rays[2 * i + 1] };
-        double value;
+        double r0 = rays[2 * i], r1 = rays[2 * i + 1];
 
         if(ENABLE_PREPROCESSING)
         {
-            double r0 = ray[0], r1 = ray[1];
-            ray[0] = pre_m[0] * r0 + pre_m[2] * r1;
-            ray[1] = pre_m[1] * r0 + pre_m[3] * r1;
+            rays_x[i] = pre_m[0] * r0 + pre_m[2] * r1;
+            rays_y[i] = pre_m[1] * r0 + pre_m[3] * r1;
 
-            ray[0] = ray[0] - floor(set->f[0] + ray[0]);
-            ray[1] = ray[1] + floor(center + 0.5 - set->f[1] - ray[1]);
+            rays_x[i] = rays_x[i] - floor(set->f[0] + rays_x[i]);
+            rays_y[i] = rays_y[i]
+                    + floor(center + 0.5 - set->f[1] - rays_y[i]);
         }
-
-        log_debug("    Ray %d (%.6lf,%.6lf)...\n", i, ray[0], ray[1]);
-
-        switch (algorithm)
+        else
         {
-            case ALGORITHM_BOUND:
-                rval = LIFTING_2D_bound(set->n_halfspaces, set->halfspaces,
-                        ray, xi_plus, xi_minus, &value);
-                abort_if(rval, "LIFTING_2D_bound failed");
-                break;
-
-            case ALGORITHM_NAIVE:
-                rval = LIFTING_2D_naive(set->n_halfspaces, set->halfspaces, ray,
-                        lb, ub, &value);
-                abort_if(rval, "LIFTING_2D_naive failed");
-                break;
-
-            case ALGORITHM_MIP:
-                rval = LIFTING_2D_mip(set->n_halfspaces, set->halfspaces, ray,
-                        &value);
-                abort_if(rval, "LIFTING_2D_mip failed");
-                break;
-
-            case ALGORITHM_HEUR:
-                rval = LIFTING_2D_heur(set->n_halfspaces, set->halfspaces, ray,
-                        &value);
-                abort_if(rval, "LIFTING_2D_heur failed");
-                break;
-
-            default:
-                abort_if(1, "Invalid algorithm");
+            rays_x[i] = r0;
+            rays_y[i] = r1;
         }
+    }
 
-        if(current_sample == 0)
+    if(algorithm == ALGORITHM_BOUND)
+    {
+        rval = LIFTING_2D_bound_batch(set->n_halfspaces, set->halfspaces,
+                N_RAYS, rays_x, rays_y, values);
+        abort_if(rval, "LIFTING_2D_bound_batch failed");
+    }
+    else
+    {
+        for (int i = 0; i < N_RAYS; i++)
         {
-            if(WRITE_ANSWERS)
-            {
-                abort_iff(!DOUBLE_geq(value, 0),
-                        "value should be non-negative (%.8lf)", value);
-                fprintf(ANSWERS_FILE, "%d %d %.20lf\n", set_idx, i, value);
-            }
+            double ray[2] = { rays_x[i], rays_y[i] };
 
-            if(CHECK_ANSWERS)
-            {
-                int count;
-                int expected_set_idx, expected_i;
-                double expected_value;
-
-                while(1)
-                {
-                    count = fscanf(ANSWERS_FILE, "%d %d %lf ",
-                            &expected_set_idx, &expected_i, &expected_value);
-
-                    abort_if(count != 3, "error reading answer");
-                    if(set_idx == expected_set_idx && i == expected_i) break;
-                }
-
-                double delta = fabs(value - expected_value);
-                if(delta > 1e-3)
-                {
-                    log_warn("    wrong answer (set=%d ray=%d answer=%.8lf"
-                            " expected=%.8lf delta=%.8lf)\n", set_idx,
-                            i, value, expected_value, delta);
-                    *wrong_answer = 1;
-                }
-            }
+            log_debug("    Ray %d (%.6lf,%.6lf)...\n", i, ray[0], ray[1]);
 
-            log_verbose("       %4d %12.8lf\n", j, value);
+            rval = lift_ray(algorithm, set, &mip, &table, lb, ub, ray,
+                    &values[i]);
+            abort_if(rval, "lift_ray failed");
         }
     }
 
+    *query_time += get_thread_time() - initial_time;
+
 CLEANUP:
+    if(algorithm == ALGORITHM_MIP) LIFTING_2D_mip_free(&mip);
+    if(algorithm == ALGORITHM_TABLE) LIFTING_2D_table_free(&table);
     return rval;
 }
 
@@ -416,7 +531,9 @@ int benchmark_set(int algorithm,
                   const double *rays,
                   const double *pre_m,
                   const double center,
-                  int *wrong_answer)
+                  double *values,
+                  double *build_time,
+                  double *query_time)
 {
     int rval = 0;
     int lb[2], ub[2];
@@ -454,7 +571,7 @@ int benchmark_set(int algorithm,
     for (int k = 0; k < N_SAMPLES_PER_SET; k ++)
     {
         rval = benchmark_set_sample(algorithm, set_idx, set, rays, pre_m,
-                center, lb, ub, k, wrong_answer);
+                center, lb, ub, k, values, build_time, query_time);
         abort_if(rval, "benchmark_set_sample failed");
     }
 
@@ -462,61 +579,280 @@ CLEANUP:
     return rval;
 }
 
-int benchmark(int n_sets, struct LFreeSet2D *sets, double *rays,
-        int algorithm)
+/**
+ * Sets read from the input file, waiting to be benchmarked. The index of
+ * sets[j] among all valid sets of the file is first_idx + j.
+ */
+struct SetChunk
+{
+    int n_sets;
+    int first_idx;
+    struct LFreeSet2D *sets;
+    double *pre_m;
+    double *center;
+};
+
+/**
+ * Per-set results, accumulated over all chunks.
+ */
+struct BenchmarkStats
+{
+    int n_sets;
+    int capacity;
+    double *times;
+    double *build_times;
+    double *query_times;
+    int *wrong;
+};
+
+static int chunk_init(struct SetChunk *chunk)
+{
+    int rval = 0;
+
+    chunk->n_sets = 0;
+    chunk->first_idx = 0;
+    chunk->sets = (struct LFreeSet2D*) calloc(N_SETS_PER_CHUNK,
+            sizeof(struct LFreeSet2D));
+    chunk->pre_m = (double*) malloc(4 * N_SETS_PER_CHUNK * sizeof(double));
+    chunk->center = (double*) malloc(N_SETS_PER_CHUNK * sizeof(double));
+    abort_if(!chunk->sets, "could not allocate chunk->sets");
+    abort_if(!chunk->pre_m, "could not allocate chunk->pre_m");
+    abort_if(!chunk->center, "could not allocate chunk->center");
+
+    for (int j = 0; j < N_SETS_PER_CHUNK; j++)
+    {
+        rval = LFREE_2D_init(&chunk->sets[j], 4, 4, 4);
+        abort_if(rval, "LFREE_2D_init failed");
+    }
+
+CLEANUP:
+    return rval;
+}
+
+static void chunk_free(struct SetChunk *chunk)
+{
+    if(chunk->sets)
+    {
+        for (int j = 0; j < N_SETS_PER_CHUNK; j++)
+            LFREE_2D_free(&chunk->sets[j]);
+
+        free(chunk->sets);
+    }
+
+    if(chunk->pre_m) free(chunk->pre_m);
+    if(chunk->center) free(chunk->center);
+}
+
+/**
+ * Reads, transforms and pre-processes the next valid sets of the file,
+ * until the chunk is full, the end of the file is reached, or max_sets
+ * sets have been read. The slots of the chunk are reused, so that memory
+ * use does not depend on the size of the file.
+ */
+static int read_chunk(FILE *sets_file,
+                      int *line,
+                      int max_sets,
+                      struct SetChunk *chunk)
+{
+    int rval = 0;
+
+    chunk->first_idx += chunk->n_sets;
+    chunk->n_sets = 0;
+
+    max_sets = min(max_sets, N_SETS_PER_CHUNK);
+
+    while(chunk->n_sets < max_sets && !feof(sets_file))
+    {
+        (*line)++;
+        struct LFreeSet2D *set = &chunk->sets[chunk->n_sets];
+
+        rval = LFREE_2D_read_next(sets_file, set);
+        abort_iff(rval, "LFREE_2D_read_next failed (line %d)", *line);
+
+        if(ENABLE_SHEAR)
+        {
+            double m[4] = { 51.0, 5.0, 10.0, 1.0 };
+            rval = LFREE_2D_transform_set(set, m);
+            abort_iff(rval, "LFREE_2D_transform_set failed (line %d)", *line);
+        }
+
+        double dx = -floor(set->f[0]);
+        double dy = -floor(set->f[1]);
+        rval = LFREE_2D_translate_set(set, dx, dy);
+        abort_iff(rval, "LFREE_2D_translate_set failed (line %d)", *line);
+
+        if(ENABLE_PREPROCESSING)
+        {
+            double *pre_m = &chunk->pre_m[chunk->n_sets * 4];
+            double *center = &chunk->center[chunk->n_sets];
+            rval = LFREE_2D_preprocess(set, pre_m, center);
+            abort_iff(rval, "LFREE_2D_preprocess failed (line %d)", *line);
+        }
+
+        rval = LFREE_2D_compute_halfspaces(set);
+        abort_iff(rval, "LFREE_2D_compute_halfspaces failed (line %d)",
+                *line);
+
+        rval = LIFTING_2D_verify(set);
+        if(rval)
+        {
+            log_warn("    skipping invalid set on line %d\n", *line);
+            rval = 0;
+            continue;
+        }
+
+        chunk->n_sets++;
+    }
+
+CLEANUP:
+    return rval;
+}
+
+static int stats_grow(struct BenchmarkStats *stats,
+                      int n_sets)
+{
+    int rval = 0;
+
+    if(n_sets <= stats->capacity) goto CLEANUP;
+
+    stats->capacity = max(2 * stats->capacity, n_sets);
+
+    stats->times = (double*) realloc(stats->times,
+            stats->capacity * sizeof(double));
+    stats->build_times = (double*) realloc(stats->build_times,
+            stats->capacity * sizeof(double));
+    stats->query_times = (double*) realloc(stats->query_times,
+            stats->capacity * sizeof(double));
+    stats->wrong = (int*) realloc(stats->wrong, stats->capacity * sizeof(int));
+
+    abort_if(!stats->times, "could not reallocate stats->times");
+    abort_if(!stats->build_times, "could not reallocate stats->build_times");
+    abort_if(!stats->query_times, "could not reallocate stats->query_times");
+    abort_if(!stats->wrong, "could not reallocate stats->wrong");
+
+CLEANUP:
+    return rval;
+}
+
+static void stats_free(struct BenchmarkStats *stats)
+{
+    if(stats->times) free(stats->times);
+    if(stats->build_times) free(stats->build_times);
+    if(stats->query_times) free(stats->query_times);
+    if(stats->wrong) free(stats->wrong);
+}
+
+/**
+ * Benchmarks the sets of a chunk in parallel, checks their answers and
+ * appends their running times to the given statistics.
+ */
+int benchmark_chunk(const struct SetChunk *chunk,
+                    const double *rays,
+                    int algorithm,
+                    struct BenchmarkStats *stats)
 {
     int rval = 0;
-    double *times = 0;
-    int *wrong = 0;
+    int n_sets = chunk->n_sets;
+    double *values = 0;
+    int *status = 0;
+
+    rval = stats_grow(stats, stats->n_sets + n_sets);
+    abort_if(rval, "stats_grow failed");
 
-    wrong = (int*) malloc(n_sets * sizeof(int));
-    times = (double*) malloc(n_sets * sizeof(double));
-    abort_if(!wrong, "could not allocate wrong");
-    abort_if(!times, "could not allocate times");
+    double *times = &stats->times[stats->n_sets];
+    double *build_times = &stats->build_times[stats->n_sets];
+    double *query_times = &stats->query_times[stats->n_sets];
+    int *wrong = &stats->wrong[stats->n_sets];
 
-    log_info("Running benchmark...\n");
+    status = (int*) malloc(n_sets * sizeof(int));
+    values = (double*) malloc(n_sets * N_RAYS * sizeof(double));
+    abort_if(!status, "could not allocate status");
+    abort_if(!values, "could not allocate values");
 
-    double total_initial_time = get_user_time();
+    log_info("Running benchmark on sets %d to %d (%d threads)...\n",
+            chunk->first_idx, chunk->first_idx + n_sets - 1, N_THREADS);
 
+    #pragma omp parallel for schedule(dynamic) num_threads(N_THREADS)
     for (int j = 0; j < n_sets; j++)
     {
-        log_debug("Set %d...\n", j);
+        int set_idx = chunk->first_idx + j;
+        log_debug("Set %d...\n", set_idx);
 
-        double set_initial_time = get_user_time();
+        double set_initial_time = get_thread_time();
 
-        struct LFreeSet2D *set = &sets[j];
-        double *pre_m = &PRE_M[j * 4];
-        double center = CENTER[j];
+        build_times[j] = query_times[j] = 0;
 
-        rval = LFREE_2D_print_set(set);
-        abort_if(rval, "LFREE_2D_print_set failed");
+        status[j] = benchmark_set(algorithm, set_idx, &chunk->sets[j], rays,
+                &chunk->pre_m[j * 4], chunk->center[j], &values[j * N_RAYS],
+                &build_times[j], &query_times[j]);
 
-        int wrong_answer = 0;
+        times[j] = get_thread_time() - set_initial_time;
+    }
 
-        rval = benchmark_set(algorithm, j, set, rays, pre_m, center, &wrong_answer);
-        abort_if(rval, "benchmark_set failed");
+    for (int j = 0; j < n_sets; j++)
+    {
+        int set_idx = chunk->first_idx + j;
 
-        double set_duration = get_user_time() - set_initial_time;
-        double avg = (set_duration / N_SAMPLES_PER_SET) * 1000;
+        rval = LFREE_2D_print_set(&chunk->sets[j]);
+        abort_if(rval, "LFREE_2D_print_set failed");
 
-        times[j] = avg;
-        wrong[j] = wrong_answer;
+        abort_iff(status[j], "benchmark_set failed (set %d)", set_idx);
 
-        log_info("  %3d: %12.3lf ms\n", j, avg);
+        rval = check_answers(set_idx, &values[j * N_RAYS], &wrong[j]);
+        abort_if(rval, "check_answers failed");
+
+        times[j] = (times[j] / N_SAMPLES_PER_SET) * 1000;
+        build_times[j] = (build_times[j] / N_SAMPLES_PER_SET) * 1000;
+        query_times[j] = (query_times[j] / N_SAMPLES_PER_SET) * 1000;
+
+        log_info("  %3d: %12.3lf ms\n", set_idx, times[j]);
     }
 
+    stats->n_sets += n_sets;
+
+CLEANUP:
+    if(status) free(status);
+    if(values) free(values);
+    return rval;
+}
+
+void print_stats(const struct BenchmarkStats *stats,
+                 int algorithm)
+{
+    int n_sets = stats->n_sets;
+
     stats_printf("cpu_time:\n");
     for(int j = 0; j < n_sets; j++)
-        stats_printf("  %d: %.8lf\n", j, times[j]);
+        stats_printf("  %d: %.8lf\n", j, stats->times[j]);
+
+    stats_printf("throughput:\n");
+    for(int j = 0; j < n_sets; j++)
+        stats_printf("  %d: %.2lf\n", j,
+                stats->times[j] > 0 ? N_RAYS / stats->times[j] * 1000 : 0);
 
     stats_printf("wrong_answer:\n");
     for(int j = 0; j < n_sets; j++)
-        stats_printf("  %d: %d\n", j, wrong[j]);
+        stats_printf("  %d: %d\n", j, stats->wrong[j]);
+
+    if(algorithm == ALGORITHM_TABLE)
+    {
+        stats_printf("build_time:\n");
+        for(int j = 0; j < n_sets; j++)
+            stats_printf("  %d: %.8lf\n", j, stats->build_times[j]);
 
-    double total_duration = get_user_time() - total_initial_time;
+        stats_printf("query_time:\n");
+        for(int j = 0; j < n_sets; j++)
+            stats_printf("  %d: %.8lf\n", j, stats->query_times[j]);
+    }
+
+    double total_time = 0;
+    for(int j = 0; j < n_sets; j++)
+        total_time += stats->times[j];
 
     log_info("    %.3lf ms per set                     \n",
-            total_duration / (n_sets * N_SAMPLES_PER_SET) * 1000);
+            total_time / n_sets);
+    log_info("    %.0lf rays per second\n",
+            n_sets * N_RAYS / total_time * 1000);
 
     if(algorithm == ALGORITHM_MIP)
     {
@@ -524,17 +860,29 @@ int benchmark(int n_sets, struct LFreeSet2D *sets, double *rays,
         log_info("    %.3lf s spent on LP_optimize\n", MIP_TIME_OPTIMIZE);
     }
 
-CLEANUP:
-    if(wrong) free(wrong);
-    if(times) free(times);
-    return rval;
+    if(algorithm == ALGORITHM_TABLE)
+    {
+        double total_build = 0, total_query = 0;
+        for(int j = 0; j < n_sets; j++)
+        {
+            total_build += stats->build_times[j];
+            total_query += stats->query_times[j];
+        }
+
+        log_info("    %.3lf ms per set building tables\n",
+                total_build / n_sets);
+        log_info("    %.3lf ms per set querying tables\n",
+                total_query / n_sets);
+    }
 }
 
 int main(int argc, char **argv)
 {
     int rval = 0;
     double *rays = 0;
-    struct LFreeSet2D sets[MAX_N_SETS];
+    FILE *sets_file = 0;
+    struct SetChunk chunk = {0};
+    struct BenchmarkStats stats = {0};
 
     rval = parse_args(argc, argv);
     if (rval) return 1;
@@ -619,66 +967,47 @@ int main(int argc, char **argv)
         log_info("Enabling heuristic algorithm\n");
         algorithm = ALGORITHM_HEUR;
     }
+    else if(SELECT_TABLE_ALGORITHM)
+    {
+        log_info("Enabling lifting table algorithm\n");
+        algorithm = ALGORITHM_TABLE;
+    }
 
     log_info("Setting %d samples per set\n", N_SAMPLES_PER_SET);
 
     if(ENABLE_PREPROCESSING)
         log_info("Enabling pre-processing\n");
 
-    log_info("Reading sets from file...\n");
-    FILE *sets_file = fopen(SETS_FILENAME, "r");
-    abort_iff(!sets_file, "could not read file %s", SETS_FILENAME);
+    if(MAX_SETS > 0)
+        log_info("Reading at most %d sets\n", MAX_SETS);
 
-    int line = 0;
-    int n_sets = 0;
-    while(!feof(sets_file))
-    {
-        line++;
-        struct LFreeSet2D *set = &sets[n_sets];
-        LFREE_2D_init(set, 4, 4, 4);
+    rval = chunk_init(&chunk);
+    abort_if(rval, "chunk_init failed");
 
-        rval = LFREE_2D_read_next(sets_file, set);
-        abort_iff(rval, "LFREE_2D_read_next failed (line %d)", line);
-
-        if(ENABLE_SHEAR)
-        {
-            double m[4] = { 51.0, 5.0, 10.0, 1.0 };
-            rval = LFREE_2D_transform_set(set, m);
-            abort_iff(rval, "LFREE_2D_transform_set failed (line %d)", line);
-        }
+    sets_file = fopen(SETS_FILENAME, "r");
+    abort_iff(!sets_file, "could not read file %s", SETS_FILENAME);
 
-        double dx = -floor(set->f[0]);
-        double dy = -floor(set->f[1]);
-        rval = LFREE_2D_translate_set(set, dx, dy);
-        abort_iff(rval, "LFREE_2D_translate_set failed (line %d)", line);
+    int line = 0;
 
-        if(ENABLE_PREPROCESSING)
-        {
-            double *pre_m = &PRE_M[n_sets * 4];
-            double *center = &CENTER[n_sets];
-            rval = LFREE_2D_preprocess(set, pre_m, center);
-            abort_iff(rval, "LFREE_2D_preprocess failed (line %d)", line);
-        }
+    while(1)
+    {
+        int remaining = INT_MAX;
+        if(MAX_SETS > 0) remaining = MAX_SETS - stats.n_sets;
 
-        rval = LFREE_2D_compute_halfspaces(set);
-        abort_iff(rval, "LFREE_2D_compute_halfspaces failed (line %d)", line);
+        log_info("Reading sets from file...\n");
+        rval = read_chunk(sets_file, &line, remaining, &chunk);
+        abort_if(rval, "read_chunk failed");
 
-        rval = LIFTING_2D_verify(set);
-        if(rval)
-        {
-            log_warn("    skipping invalid set on line %d\n", line);
-            continue;
-        }
+        if(chunk.n_sets == 0) break;
 
-        n_sets++;
-        if(n_sets >= MAX_N_SETS) break;
+        rval = benchmark_chunk(&chunk, rays, algorithm, &stats);
+        abort_if(rval, "benchmark_chunk failed");
     }
 
-    fclose(sets_file);
-    log_info("Successfully read %d sets\n", n_sets);
+    log_info("Successfully read %d sets\n", stats.n_sets);
+    abort_if(stats.n_sets == 0, "no valid sets found");
 
-    rval = benchmark(n_sets, sets, rays, algorithm);
-    abort_if(rval, "benchmark failed");
+    print_stats(&stats, algorithm);
 
     log_info("Done.\n");
 
@@ -686,6 +1015,10 @@ CLEANUP:
     if (LOG_FILE) fclose(LOG_FILE);
     if (STATS_FILE) fclose(STATS_FILE);
     if (ANSWERS_FILE) fclose(ANSWERS_FILE);
+    if (sets_file) fclose(sets_file);
     if (rays) free(rays);
+    chunk_free(&chunk);
+    stats_free(&stats);
+    LP_pool_free();
     return rval;
 }
@@ -17,12 +17,45 @@
 #ifndef LIFTING_MIP_H
 #define LIFTING_MIP_H
 
+#include <multirow/lp.h>
+
 extern double MIP_TIME_OPTIMIZE;
 extern double MIP_TIME_CREATE;
 
-int LIFTING_2D_mip_init();
+/**
+ * Lifting MIP of a fixed lattice-free set. The problem is built once per set,
+ * and only its right-hand sides change from one ray to the next. They are
+ * all updated at once, through rhs_indices and rhs. The solution found for
+ * the previous ray is used as a MIP start for the next one.
+ */
+struct LiftingMIP
+{
+    struct LP lp;
+    int n_halfspaces;
+    const double *halfspaces;
+
+    int *rhs_indices;
+    double *rhs;
+
+    int has_start;
+    double start[2];
+};
+
+int LIFTING_2D_mip_create(struct LiftingMIP *mip,
+                          int n_halfspaces,
+                          const double *halfspaces);
+
+void LIFTING_2D_mip_free(struct LiftingMIP *mip);
+
+int LIFTING_2D_mip_solve(struct LiftingMIP *mip,
+                         const double *ray,
+                         double *value);
 
-void LIFTING_2D_mip_cleanup();
+int LIFTING_2D_mip_batch(int n_halfspaces,
+                         const double *halfspaces,
+                         int n_rays,
+                         const double *rays,
+                         double *values);
 
 int LIFTING_2D_mip(int n_halfspaces,
                    const double *halfspaces,
@@ -0,0 +1,71 @@
+/* Copyright (c) 2016 Laurent Poirrier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIFTING_TABLE_H
+#define LIFTING_TABLE_H
+
+/**
+ * Node of the quadtree of a lifting table. Internal nodes have four
+ * children, stored consecutively, starting at index children. Leaves have
+ * children = -1, and point to the groups [group_begin, group_end).
+ */
+struct LiftingTableNode
+{
+    int children;
+    int group_begin;
+    int group_end;
+};
+
+/**
+ * Decomposition of the unit cell [0,1)^2 into the regions of the trivial
+ * lifting function of a lattice-free set.
+ *
+ * Inside each leaf of the quadtree, the lifting function is the minimum,
+ * over the groups of the leaf, of the maximum, over the terms of each group,
+ * of the affine function t[0] * r[0] + t[1] * r[1] + t[2]. Each group
+ * corresponds to an integer translate of the set. Each term corresponds to
+ * a facet of the translate. Group g has terms [terms_begin[g],
+ * terms_begin[g+1]), and each term is stored as three consecutive values.
+ */
+struct LiftingTable
+{
+    int n_nodes;
+    int node_capacity;
+    struct LiftingTableNode *nodes;
+
+    int n_groups;
+    int group_capacity;
+    int *terms_begin;
+
+    int n_terms;
+    int term_capacity;
+    double *terms;
+
+    int depth;
+};
+
+int LIFTING_2D_table_build(int n_halfspaces,
+                           const double *halfspaces,
+                           int max_depth,
+                           struct LiftingTable *table);
+
+void LIFTING_2D_table_free(struct LiftingTable *table);
+
+int LIFTING_2D_table_query(const struct LiftingTable *table,
+                           const double *ray,
+                           double *value);
+
+#endif
@@ -57,4 +57,18 @@ int LIFTING_2D_heur(int n_halfspaces,
 
 int LIFTING_2D_verify(struct LFreeSet2D *set);
 
+int LIFTING_2D_psi_batch(int n_halfspaces,
+                         const double *halfspaces,
+                         int n_rays,
+                         const double *rays_x,
+                         const double *rays_y,
+                         double *values);
+
+int LIFTING_2D_bound_batch(int n_halfspaces,
+                           const double *halfspaces,
+                           int n_rays,
+                           const double *rays_x,
+                           const double *rays_y,
+                           double *values);
+
 #endif //LIFTING_H
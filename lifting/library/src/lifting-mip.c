@@ -14,6 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include <stdlib.h>
+
 #include <multirow/util.h>
 #include <multirow/lp.h>
 #include <lifting/lifting-mip.h>
@@ -22,141 +25,197 @@ double MIP_TIME_OPTIMIZE = 0;
 double MIP_TIME_CREATE = 0;
 
 /**
- * Returns non-zero if the cplex_env part of struct LP is initialized.
+ * Builds the lifting MIP of the given lattice-free set. The problem is
+ * created in the calling thread's environment from the LP pool, so that
+ * several threads may build and solve their own problems concurrently.
  *
- * @param lp  pointer to a struct LP
- */
-int LP_is_open(struct LP *lp)
-{
-    return (lp->cplex_env != 0);
-}
-
-/**
- * Frees the cplex_lp part of struct LP, leaving the environment open.
+ * The right-hand sides are left at zero; they are set by
+ * LIFTING_2D_mip_solve() for each ray. The array halfspaces is not copied,
+ * and should remain valid until LIFTING_2D_mip_free() is called.
  *
- * @param lp  pointer to a struct LP
+ * @param[out] mip           problem to build
+ * @param[in]  n_halfspaces  number of facets of the lattice-free set used
+ * @param[in]  halfspaces    description of the lattice-free set used
  */
-void LP_destroy(struct LP *lp)
+int LIFTING_2D_mip_create(struct LiftingMIP *mip,
+                          int n_halfspaces,
+                          const double *halfspaces)
 {
-    if(!lp) return;
-    if(!lp->cplex_env) return;
+    int rval = 0;
+
+    double rhs = 0.0;
+    char sense = 'G';
+    int beg = 0;
+    int ind[3] = {0, 1, 2};
+    double val[3];
 
-    if(lp->cplex_lp)
-        CPXfreeprob(lp->cplex_env, &(lp->cplex_lp));
+    double initial_time = get_thread_time();
 
-    lp->cplex_lp = 0;
-}
+    mip->lp.cplex_env = 0;
+    mip->lp.cplex_lp = 0;
+    mip->n_halfspaces = n_halfspaces;
+    mip->halfspaces = halfspaces;
+    mip->has_start = 0;
 
-/**
- * Static data for LIFTING_2D_mip().
- *
- * Warning: Because of this, LIFTING_2D_mip() is not thread safe.
- */
-static struct LP LIFTING_2D_mip_lp = {0, 0};
+    mip->rhs_indices = (int*) malloc(n_halfspaces * sizeof(int));
+    mip->rhs = (double*) malloc(n_halfspaces * sizeof(double));
+    abort_if(!mip->rhs_indices, "could not allocate mip->rhs_indices");
+    abort_if(!mip->rhs, "could not allocate mip->rhs");
 
-/**
- * Opens the cplex environment of the struct LP used by LIFTING_2D_mip().
- *
- * This is called automatically by LIFTING_2D_mip().
- */
-int LIFTING_2D_mip_init()
-{
-    struct LP *lp = &LIFTING_2D_mip_lp;
+    for(int i = 0; i < n_halfspaces; i++)
+        mip->rhs_indices[i] = i;
+
+    rval = LP_pool_acquire(&mip->lp);
+    abort_if(rval, "LP_pool_acquire failed");
+
+    rval = LP_create(&mip->lp, "lifting2d");
+    abort_if(rval, "LP_create failed");
 
-    if(!LP_is_open(lp))
+    rval = LP_new_col(&mip->lp, 1.0, 0.0, MILP_INFINITY, 'C');
+    rval |= LP_new_col(&mip->lp, 0.0, -MILP_INFINITY, MILP_INFINITY, 'I');
+    rval |= LP_new_col(&mip->lp, 0.0, -MILP_INFINITY, MILP_INFINITY, 'I');
+    abort_if(rval, "LP_new_col failed");
+
+    val[0] = 1.0;
+
+    for(int i = 0; i < n_halfspaces; i++)
     {
-        if(LP_open(lp)) return (-1);
+        val[1] = -halfspaces[i * 2 + 0];
+        val[2] = -halfspaces[i * 2 + 1];
+
+        rval = LP_add_rows(&mip->lp, 1, 3, &rhs, &sense, &beg, ind, val);
+        abort_if(rval, "LP_add_rows failed");
     }
 
-    return (0);
+    #pragma omp atomic
+    MIP_TIME_CREATE += get_thread_time() - initial_time;
+
+CLEANUP:
+    if(rval) LIFTING_2D_mip_free(mip);
+    return (rval);
 }
 
-/**
- * Closes the cplex environment of the struct LP used by LIFTING_2D_mip().
- *
- * This function should be called by the user of LIFTING_2D_mip(), if
- * cleaning up the environment is desired.
- */
-void LIFTING_2D_mip_cleanup()
+void LIFTING_2D_mip_free(struct LiftingMIP *mip)
 {
-    struct LP *lp = &LIFTING_2D_mip_lp;
-
-    LP_free(lp);
+    LP_pool_release(&mip->lp);
+    if(mip->rhs_indices) free(mip->rhs_indices);
+    if(mip->rhs) free(mip->rhs);
+    mip->rhs_indices = 0;
+    mip->rhs = 0;
 }
 
 /*
- * Computes the lifting coefficient of a ray by formulating the lifting
- * problem as a MIP.
+ * Computes the lifting coefficient of a ray by re-solving the lifting MIP
+ * built by LIFTING_2D_mip_create(), after updating its right-hand sides.
  *
- * @param[in]  n_halfspaces  number of facets of the lattice-free set used
- * @param[in]  halfspaces    description of the lattice-free set used
- * @param[in]  ray           ray to lift
- * @param[out] value         lifting coefficient
+ * @param[in]  mip    lifting problem of the lattice-free set used
+ * @param[in]  ray    ray to lift
+ * @param[out] value  lifting coefficient
  */
-int LIFTING_2D_mip(int n_halfspaces,
-                   const double *halfspaces,
-                   const double *ray,
-                   double *value)
+int LIFTING_2D_mip_solve(struct LiftingMIP *mip,
+                         const double *ray,
+                         double *value)
 {
-    struct LP *lp = &LIFTING_2D_mip_lp;
     int rval = 0;
+    int infeasible;
+    int start_indices[2] = {1, 2};
+    double x[3];
+    double obj;
 
-    double initial_time = get_user_time();
-
-    rval = LIFTING_2D_mip_init();
-    abort_if(rval, "LIFTING_2D_mip_init failed");
-
-    rval = LP_create(lp, "lifting2d");
-    abort_if(rval, "LP_create failed");
-
-    rval = LP_new_col(lp, 1.0, 0.0, MILP_INFINITY, 'C');
-    rval |= LP_new_col(lp, 0.0, -MILP_INFINITY, MILP_INFINITY, 'I');
-    rval |= LP_new_col(lp, 0.0, -MILP_INFINITY, MILP_INFINITY, 'I');
-    abort_if(rval, "LP_new_col failed");
+    double initial_time = get_thread_time();
 
-    double rhs;
-    char sense = 'G';
-    int beg = 0;
-    int ind[3] = {0, 1, 2};
-    double val[3];
+    for(int i = 0; i < mip->n_halfspaces; i++)
+    {
+        double a0 = mip->halfspaces[i * 2 + 0];
+        double a1 = mip->halfspaces[i * 2 + 1];
+        mip->rhs[i] = a0 * ray[0] + a1 * ray[1];
+    }
 
-    val[0] = 1.0;
+    rval = LP_change_rhs_list(&mip->lp, mip->n_halfspaces, mip->rhs_indices,
+            mip->rhs);
+    abort_if(rval, "LP_change_rhs_list failed");
 
-    for(int i = 0; i < n_halfspaces; i++)
+    if(mip->has_start)
     {
-        double a0 = halfspaces[i * 2 + 0];
-        double a1 = halfspaces[i * 2 + 1];
-
-        rhs = a0 * ray[0] + a1 * ray[1];
+        rval = LP_set_mip_start(&mip->lp, 2, start_indices, mip->start);
+        abort_if(rval, "LP_set_mip_start failed");
+    }
 
-        val[1] = -a0;
-        val[2] = -a1;
+    rval = LP_optimize(&mip->lp, &infeasible);
+    abort_if(rval, "LP_optimize failed");
+    abort_if(infeasible, "LIFTING_2D_mip infeasible");
 
-        rval |= LP_add_rows(lp, 1, 3, &rhs, &sense, &beg, ind, val);
-    }
+    #pragma omp atomic
+    MIP_TIME_OPTIMIZE += get_thread_time() - initial_time;
 
-    MIP_TIME_CREATE += get_user_time() - initial_time;
+    rval = LP_get_obj_val(&mip->lp, &obj);
+    abort_if(rval, "LP_get_obj_val failed");
 
-    abort_if(rval, "LP_add_rows failed");
+    rval = LP_get_x(&mip->lp, x);
+    abort_if(rval, "LP_get_x failed");
 
-    int infeasible;
+    // Any integral point is feasible for every ray, so the current solution
+    // is a valid start for the next one
+    mip->start[0] = round(x[1]);
+    mip->start[1] = round(x[2]);
+    mip->has_start = 1;
 
-    initial_time = get_user_time();
+    *value = obj;
 
-    rval = LP_optimize(lp, &infeasible);
-    abort_if(rval, "LP_optimize failed");
-    abort_if(infeasible, "LIFTING_2D_mip infeasible");
+CLEANUP:
+    return (rval);
+}
 
-    MIP_TIME_OPTIMIZE += get_user_time() - initial_time;
+/*
+ * Computes the lifting coefficients of several rays, using a single lifting
+ * MIP for the given lattice-free set.
+ *
+ * @param[in]  n_halfspaces  number of facets of the lattice-free set used
+ * @param[in]  halfspaces    description of the lattice-free set used
+ * @param[in]  n_rays        number of rays to lift
+ * @param[in]  rays          rays to lift, stored consecutively
+ * @param[out] values        lifting coefficient of each ray
+ */
+int LIFTING_2D_mip_batch(int n_halfspaces,
+                         const double *halfspaces,
+                         int n_rays,
+                         const double *rays,
+                         double *values)
+{
+    int rval = 0;
+    int created = 0;
+    struct LiftingMIP mip;
 
-    double obj;
+    rval = LIFTING_2D_mip_create(&mip, n_halfspaces, halfspaces);
+    abort_if(rval, "LIFTING_2D_mip_create failed");
 
-    rval = LP_get_obj_val(lp, &obj);
-    abort_if(rval, "LP_get_obj_val failed");
+    created = 1;
 
-    *value = obj;
+    for(int i = 0; i < n_rays; i++)
+    {
+        rval = LIFTING_2D_mip_solve(&mip, &rays[2 * i], &values[i]);
+        abort_if(rval, "LIFTING_2D_mip_solve failed");
+    }
 
 CLEANUP:
-    LP_destroy(lp);
+    if(created) LIFTING_2D_mip_free(&mip);
     return (rval);
 }
+
+/*
+ * Computes the lifting coefficient of a ray by formulating the lifting
+ * problem as a MIP. To lift several rays with the same set, use
+ * LIFTING_2D_mip_batch() or LIFTING_2D_mip_solve() instead.
+ *
+ * @param[in]  n_halfspaces  number of facets of the lattice-free set used
+ * @param[in]  halfspaces    description of the lattice-free set used
+ * @param[in]  ray           ray to lift
+ * @param[out] value         lifting coefficient
+ */
+int LIFTING_2D_mip(int n_halfspaces,
+                   const double *halfspaces,
+                   const double *ray,
+                   double *value)
+{
+    return LIFTING_2D_mip_batch(n_halfspaces, halfspaces, 1, ray, value);
+}
@@ -0,0 +1,629 @@
+/* Copyright (c) 2016 Laurent Poirrier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <multirow/double.h>
+#include <multirow/util.h>
+#include <lifting/lifting.h>
+#include <lifting/lifting-table.h>
+
+/*
+ * Number of squares per side of the grid used to bound the lifting function
+ * over the unit cell.
+ */
+#define LIFTING_TABLE_GRID 8
+
+/**
+ * Candidate translates of the set, in the same format as the groups and
+ * terms of struct LiftingTable.
+ */
+struct Candidates
+{
+    int n_groups;
+    int *terms_begin;
+    double *terms;
+};
+
+static int alloc_candidates(int n_groups,
+                            int n_terms,
+                            struct Candidates *cand)
+{
+    int rval = 0;
+
+    cand->n_groups = 0;
+    cand->terms_begin = (int *) malloc((n_groups + 1) * sizeof(int));
+    cand->terms = (double *) malloc(3 * n_terms * sizeof(double));
+    abort_if(!cand->terms_begin, "could not allocate cand->terms_begin");
+    abort_if(!cand->terms, "could not allocate cand->terms");
+
+    cand->terms_begin[0] = 0;
+
+CLEANUP:
+    return rval;
+}
+
+static void free_candidates(struct Candidates *cand)
+{
+    if(cand->terms_begin) free(cand->terms_begin);
+    if(cand->terms) free(cand->terms);
+}
+
+/**
+ * Removes the candidates that never attain the minimum inside the box
+ * [x0, x0 + w] x [y0, y0 + w], and the terms that never attain the maximum
+ * of their group inside the same box.
+ *
+ * A term is removed if its largest value on the box does not exceed the
+ * smallest value of another term of its group. A group is removed if a lower
+ * bound on its value on the box is not smaller than the largest value of
+ * another group. The removed terms and groups are therefore dominated
+ * everywhere in the box, and the lifting function is unchanged there.
+ */
+static void prune_candidates(const struct Candidates *in,
+                             double x0,
+                             double y0,
+                             double w,
+                             struct Candidates *out)
+{
+    double corners[4][2] = {{x0, y0}, {x0 + w, y0}, {x0, y0 + w},
+                            {x0 + w, y0 + w}};
+
+    int best_group = -1;
+    double best_upper = INFINITY;
+
+    for(int g = 0; g < in->n_groups; g++)
+    {
+        double upper = -INFINITY;
+
+        for(int c = 0; c < 4; c++)
+        {
+            double v = -INFINITY;
+
+            for(int j = in->terms_begin[g]; j < in->terms_begin[g + 1]; j++)
+            {
+                const double *t = &in->terms[3 * j];
+                v = fmax(v, t[0] * corners[c][0] + t[1] * corners[c][1] + t[2]);
+            }
+
+            upper = fmax(upper, v);
+        }
+
+        if(upper < best_upper)
+        {
+            best_upper = upper;
+            best_group = g;
+        }
+    }
+
+    out->n_groups = 0;
+    out->terms_begin[0] = 0;
+
+    int n_terms = 0;
+
+    for(int g = 0; g < in->n_groups; g++)
+    {
+        int best_term = -1;
+        double lower = -INFINITY;
+
+        for(int j = in->terms_begin[g]; j < in->terms_begin[g + 1]; j++)
+        {
+            const double *t = &in->terms[3 * j];
+            double lo = t[0] * x0 + t[1] * y0 + t[2] + fmin(t[0], 0) * w
+                    + fmin(t[1], 0) * w;
+
+            if(lo > lower)
+            {
+                lower = lo;
+                best_term = j;
+            }
+        }
+
+        if(g != best_group && lower >= best_upper) continue;
+
+        for(int j = in->terms_begin[g]; j < in->terms_begin[g + 1]; j++)
+        {
+            const double *t = &in->terms[3 * j];
+            double hi = t[0] * x0 + t[1] * y0 + t[2] + fmax(t[0], 0) * w
+                    + fmax(t[1], 0) * w;
+
+            if(j != best_term && hi <= lower) continue;
+
+            double *u = &out->terms[3 * n_terms];
+            u[0] = t[0];
+            u[1] = t[1];
+            u[2] = t[2];
+            n_terms++;
+        }
+
+        out->n_groups++;
+        out->terms_begin[out->n_groups] = n_terms;
+    }
+}
+
+static int push_node(struct LiftingTable *table,
+                     int count)
+{
+    int rval = 0;
+
+    if(table->n_nodes + count > table->node_capacity)
+    {
+        table->node_capacity = 2 * (table->n_nodes + count);
+        table->nodes = (struct LiftingTableNode *) realloc(table->nodes,
+                table->node_capacity * sizeof(struct LiftingTableNode));
+        abort_if(!table->nodes, "could not reallocate table->nodes");
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        struct LiftingTableNode *node = &table->nodes[table->n_nodes + i];
+        node->children = -1;
+        node->group_begin = node->group_end = 0;
+    }
+
+    table->n_nodes += count;
+
+CLEANUP:
+    return rval;
+}
+
+static int push_leaf(struct LiftingTable *table,
+                     int node_idx,
+                     const struct Candidates *cand)
+{
+    int rval = 0;
+
+    int n_terms = cand->terms_begin[cand->n_groups];
+
+    if(table->n_groups + cand->n_groups + 1 > table->group_capacity)
+    {
+        table->group_capacity = 2 * (table->n_groups + cand->n_groups + 1);
+        table->terms_begin = (int *) realloc(table->terms_begin,
+                table->group_capacity * sizeof(int));
+        abort_if(!table->terms_begin,
+                "could not reallocate table->terms_begin");
+    }
+
+    if(table->n_terms + n_terms > table->term_capacity)
+    {
+        table->term_capacity = 2 * (table->n_terms + n_terms);
+        table->terms = (double *) realloc(table->terms,
+                3 * table->term_capacity * sizeof(double));
+        abort_if(!table->terms, "could not reallocate table->terms");
+    }
+
+    struct LiftingTableNode *node = &table->nodes[node_idx];
+    node->group_begin = table->n_groups;
+    node->group_end = table->n_groups + cand->n_groups;
+
+    for(int g = 0; g < cand->n_groups; g++)
+        table->terms_begin[table->n_groups + g] = table->n_terms
+                + cand->terms_begin[g];
+
+    for(int j = 0; j < 3 * n_terms; j++)
+        table->terms[3 * table->n_terms + j] = cand->terms[j];
+
+    table->n_groups += cand->n_groups;
+    table->n_terms += n_terms;
+    table->terms_begin[table->n_groups] = table->n_terms;
+
+CLEANUP:
+    return rval;
+}
+
+/**
+ * Builds the subtree rooted at the given node, which covers the box
+ * [x0, x0 + w] x [y0, y0 + w]. The candidates should already have been
+ * pruned against this box.
+ */
+static int build_node(struct LiftingTable *table,
+                      int node_idx,
+                      const struct Candidates *cand,
+                      double x0,
+                      double y0,
+                      double w,
+                      int depth,
+                      int max_depth)
+{
+    int rval = 0;
+    struct Candidates child = {0};
+
+    table->depth = max(table->depth, depth);
+
+    int n_terms = cand->terms_begin[cand->n_groups];
+    if(depth == max_depth || n_terms <= 1)
+    {
+        rval = push_leaf(table, node_idx, cand);
+        abort_if(rval, "push_leaf failed");
+        goto CLEANUP;
+    }
+
+    rval = alloc_candidates(cand->n_groups, n_terms, &child);
+    abort_if(rval, "alloc_candidates failed");
+
+    int first_child = table->n_nodes;
+    rval = push_node(table, 4);
+    abort_if(rval, "push_node failed");
+
+    table->nodes[node_idx].children = first_child;
+
+    w /= 2;
+
+    for(int c = 0; c < 4; c++)
+    {
+        double cx = x0 + (c % 2) * w;
+        double cy = y0 + (c / 2) * w;
+
+        prune_candidates(cand, cx, cy, w, &child);
+
+        rval = build_node(table, first_child + c, &child, cx, cy, w,
+                depth + 1, max_depth);
+        abort_if(rval, "build_node failed");
+    }
+
+CLEANUP:
+    free_candidates(&child);
+    return rval;
+}
+
+/**
+ * Computes an upper bound on the lifting function over the unit cell. The
+ * cell is split into a grid of LIFTING_TABLE_GRID x LIFTING_TABLE_GRID
+ * squares, and the function is evaluated at the center c of each square.
+ * Since psi is sublinear, the lifting function at any point r of the square
+ * is at most its value at c plus psi(r - c).
+ */
+static int find_upper_bound(int n_halfspaces,
+                            const double *halfspaces,
+                            double *upper)
+{
+    int rval = 0;
+
+    double xi_plus, xi_minus, ignored;
+    double radius = 0;
+    double h = 0.5 / LIFTING_TABLE_GRID;
+
+    rval = LIFTING_2D_optimize_continuous(n_halfspaces, halfspaces, 1,
+            &ignored, &xi_plus);
+    abort_if(rval, "LIFTING_2D_optimize_continuous failed");
+
+    rval = LIFTING_2D_optimize_continuous(n_halfspaces, halfspaces, -1,
+            &ignored, &xi_minus);
+    abort_if(rval, "LIFTING_2D_optimize_continuous failed");
+
+    for(int c = 0; c < 4; c++)
+    {
+        double d[2] = { (c % 2 ? h : -h), (c / 2 ? h : -h) };
+        double value;
+
+        rval = LIFTING_2D_psi(n_halfspaces, halfspaces, d, &value);
+        abort_if(rval, "LIFTING_2D_psi failed");
+
+        radius = fmax(radius, value);
+    }
+
+    *upper = 0;
+
+    for(int i = 0; i < LIFTING_TABLE_GRID; i++)
+    {
+        for(int j = 0; j < LIFTING_TABLE_GRID; j++)
+        {
+            double center[2] = { (2 * i + 1) * h, (2 * j + 1) * h };
+            double value;
+
+            rval = LIFTING_2D_bound(n_halfspaces, halfspaces, center, xi_plus,
+                    xi_minus, &value);
+            abort_if(rval, "LIFTING_2D_bound failed");
+
+            *upper = fmax(*upper, value + radius);
+        }
+    }
+
+CLEANUP:
+    return rval;
+}
+
+/**
+ * Computes an upper bound on the lifting function over the unit cell, and
+ * the range of rows k[1] of the integer translates k such that psi(r + k)
+ * does not exceed this bound for some r in the cell. Fails if the set is
+ * unbounded.
+ */
+static int find_translate_rows(int n_halfspaces,
+                               const double *halfspaces,
+                               double *upper,
+                               int *lb,
+                               int *ub)
+{
+    int rval = 0;
+
+    for(int i = 0; i < n_halfspaces; i++)
+    {
+        const double *h = &halfspaces[2 * i];
+
+        for(int s = -1; s <= 1; s += 2)
+        {
+            double d[2] = { -s * h[1], s * h[0] };
+            int is_recession = 1;
+
+            for(int j = 0; j < n_halfspaces; j++)
+            {
+                const double *hj = &halfspaces[2 * j];
+                if(!DOUBLE_leq(hj[0] * d[0] + hj[1] * d[1], 0))
+                    is_recession = 0;
+            }
+
+            abort_if(is_recession, "lattice-free set should be bounded");
+        }
+    }
+
+    rval = find_upper_bound(n_halfspaces, halfspaces, upper);
+    abort_if(rval, "find_upper_bound failed");
+
+    double lower_y = INFINITY;
+    double upper_y = -INFINITY;
+
+    for(int i = 0; i < n_halfspaces; i++)
+    {
+        for(int j = i + 1; j < n_halfspaces; j++)
+        {
+            const double *hi = &halfspaces[2 * i];
+            const double *hj = &halfspaces[2 * j];
+
+            double det = hi[0] * hj[1] - hi[1] * hj[0];
+            if(DOUBLE_iszero(det)) continue;
+
+            double x[2] = { *upper * (hj[1] - hi[1]) / det,
+                            *upper * (hi[0] - hj[0]) / det };
+
+            int is_feasible = 1;
+            for(int k = 0; k < n_halfspaces; k++)
+            {
+                const double *hk = &halfspaces[2 * k];
+                if(!DOUBLE_leq(hk[0] * x[0] + hk[1] * x[1], *upper))
+                    is_feasible = 0;
+            }
+
+            if(!is_feasible) continue;
+
+            lower_y = fmin(lower_y, x[1]);
+            upper_y = fmax(upper_y, x[1]);
+        }
+    }
+
+    abort_if(isinf(lower_y), "could not find vertices");
+
+    *lb = (int) floor(lower_y) - 1;
+    *ub = (int) ceil(upper_y);
+
+CLEANUP:
+    return rval;
+}
+
+/**
+ * Computes the range of columns k[0] of the integer translates k in row
+ * k[1] such that psi(r + k) may not exceed the given bound for some r in
+ * the unit cell. Each facet is relaxed independently over the row, so the
+ * range may contain a few translates that are discarded later.
+ */
+static void find_translate_columns(int n_halfspaces,
+                                   const double *halfspaces,
+                                   double upper,
+                                   int k1,
+                                   int *lb,
+                                   int *ub)
+{
+    double lower_x = -INFINITY;
+    double upper_x = INFINITY;
+
+    for(int i = 0; i < n_halfspaces; i++)
+    {
+        const double *h = &halfspaces[2 * i];
+        double slack = upper - fmin(h[1] * k1, h[1] * (k1 + 1));
+
+        if(DOUBLE_iszero(h[0]))
+        {
+            if(slack < 0) upper_x = -INFINITY;
+            continue;
+        }
+
+        if(h[0] > 0) upper_x = fmin(upper_x, slack / h[0]);
+        else lower_x = fmax(lower_x, slack / h[0]);
+    }
+
+    if(lower_x > upper_x)
+    {
+        *lb = 1;
+        *ub = 0;
+    }
+    else
+    {
+        *lb = (int) ceil(lower_x) - 1;
+        *ub = (int) floor(upper_x);
+    }
+}
+
+/**
+ * Precomputes the trivial lifting function of a bounded lattice-free set.
+ *
+ * Since the lifting function is periodic modulo Z^2, it is enough to
+ * describe it on the unit cell. On each point r of the cell, it equals the
+ * minimum of psi(r + k) over the integer translates k that may attain a
+ * value below an upper bound on the lifting function over the cell.
+ * The cell is recursively split into four quadrants, and the translates and
+ * facets that are dominated inside each quadrant are discarded, until a
+ * single affine function remains or max_depth is reached.
+ *
+ * @param[in]  n_halfspaces  number of facets of the lattice-free set
+ * @param[in]  halfspaces    description of the lattice-free set
+ * @param[in]  max_depth     maximum depth of the quadtree
+ * @param[out] table         table to build; should be freed with
+ *                           LIFTING_2D_table_free
+ *
+ * Returns ERR_TABLE_TOO_LARGE if more than MAX_LATTICE_POINTS translates
+ * would have to be considered. This happens for very thin sets, for which
+ * the upper bound on the lifting function is weak.
+ */
+int LIFTING_2D_table_build(int n_halfspaces,
+                           const double *halfspaces,
+                           int max_depth,
+                           struct LiftingTable *table)
+{
+    int rval = 0;
+    int lb[2], ub[2];
+    double upper;
+    struct Candidates all = {0};
+    struct Candidates root = {0};
+
+    table->n_nodes = table->node_capacity = 0;
+    table->n_groups = table->group_capacity = 0;
+    table->n_terms = table->term_capacity = 0;
+    table->nodes = 0;
+    table->terms_begin = 0;
+    table->terms = 0;
+    table->depth = 0;
+
+    rval = find_translate_rows(n_halfspaces, halfspaces, &upper, &lb[1],
+            &ub[1]);
+    abort_if(rval, "find_translate_rows failed");
+
+    int n_groups = 0;
+
+    for(int k1 = lb[1]; k1 <= ub[1]; k1++)
+    {
+        find_translate_columns(n_halfspaces, halfspaces, upper, k1, &lb[0],
+                &ub[0]);
+        n_groups += max(0, ub[0] - lb[0] + 1);
+    }
+
+    if(n_groups > MAX_LATTICE_POINTS)
+    {
+        log_debug("Lifting table: too many translates (%d)\n", n_groups);
+        rval = ERR_TABLE_TOO_LARGE;
+        goto CLEANUP;
+    }
+
+    rval = alloc_candidates(n_groups, n_groups * n_halfspaces, &all);
+    abort_if(rval, "alloc_candidates failed");
+
+    rval = alloc_candidates(n_groups, n_groups * n_halfspaces, &root);
+    abort_if(rval, "alloc_candidates failed");
+
+    for(int k1 = lb[1]; k1 <= ub[1]; k1++)
+    {
+        find_translate_columns(n_halfspaces, halfspaces, upper, k1, &lb[0],
+                &ub[0]);
+
+        for(int k0 = lb[0]; k0 <= ub[0]; k0++)
+        {
+            int begin = all.terms_begin[all.n_groups];
+
+            for(int i = 0; i < n_halfspaces; i++)
+            {
+                const double *h = &halfspaces[2 * i];
+                double *t = &all.terms[3 * (begin + i)];
+                t[0] = h[0];
+                t[1] = h[1];
+                t[2] = h[0] * k0 + h[1] * k1;
+            }
+
+            all.n_groups++;
+            all.terms_begin[all.n_groups] = begin + n_halfspaces;
+        }
+    }
+
+    prune_candidates(&all, 0, 0, 1, &root);
+
+    rval = push_node(table, 1);
+    abort_if(rval, "push_node failed");
+
+    rval = build_node(table, 0, &root, 0, 0, 1, 0, max_depth);
+    abort_if(rval, "build_node failed");
+
+    log_debug("Lifting table: %d translates, %d nodes, %d groups, %d terms,"
+            " depth %d\n", all.n_groups, table->n_nodes, table->n_groups,
+            table->n_terms, table->depth);
+
+CLEANUP:
+    free_candidates(&all);
+    free_candidates(&root);
+    if(rval) LIFTING_2D_table_free(table);
+    return rval;
+}
+
+void LIFTING_2D_table_free(struct LiftingTable *table)
+{
+    if(table->nodes) free(table->nodes);
+    if(table->terms_begin) free(table->terms_begin);
+    if(table->terms) free(table->terms);
+
+    table->nodes = 0;
+    table->terms_begin = 0;
+    table->terms = 0;
+    table->n_nodes = table->n_groups = table->n_terms = 0;
+}
+
+/**
+ * Evaluates the trivial lifting function at the given ray, using a table
+ * built by LIFTING_2D_table_build. The leaf containing the ray is located
+ * by descending the quadtree, and the function is then evaluated from the
+ * affine pieces stored in the leaf.
+ */
+int LIFTING_2D_table_query(const struct LiftingTable *table,
+                           const double *ray,
+                           double *value)
+{
+    int rval = 0;
+
+    double r[2] = { ray[0] - floor(ray[0]), ray[1] - floor(ray[1]) };
+    double x0 = 0, y0 = 0, w = 1;
+
+    const struct LiftingTableNode *node = &table->nodes[0];
+
+    while(node->children >= 0)
+    {
+        w /= 2;
+
+        int right = (r[0] >= x0 + w);
+        int top = (r[1] >= y0 + w);
+
+        x0 += right * w;
+        y0 += top * w;
+
+        node = &table->nodes[node->children + right + 2 * top];
+    }
+
+    *value = INFINITY;
+
+    for(int g = node->group_begin; g < node->group_end; g++)
+    {
+        double v = -INFINITY;
+
+        for(int j = table->terms_begin[g]; j < table->terms_begin[g + 1]; j++)
+        {
+            const double *t = &table->terms[3 * j];
+            v = fmax(v, t[0] * r[0] + t[1] * r[1] + t[2]);
+        }
+
+        *value = fmin(*value, v);
+    }
+
+    abort_if(isinf(*value), "empty leaf in lifting table");
+
+CLEANUP:
+    return rval;
+}
@@ -25,6 +25,12 @@
 #include <multirow/lfree2d.h>
 #include <lifting/lifting.h>
 
+/*
+ * Number of rays processed together by the batch functions. Their working
+ * arrays are kept on the stack.
+ */
+#define LIFTING_BATCH_SIZE 64
+
 /**
  * Verifies if the set is well formed.
  */
@@ -293,3 +299,178 @@ int LIFTING_2D_bound(int n_halfspaces,
 CLEANUP:
     return rval;
 }
+
+/**
+ * Evaluates psi for a batch of rays, stored as separate arrays of first and
+ * second coordinates. The loop over the rays is innermost, so that several
+ * rays are evaluated at once by the vector units of the processor.
+ */
+int LIFTING_2D_psi_batch(int n_halfspaces,
+                         const double *halfspaces,
+                         int n_rays,
+                         const double *rays_x,
+                         const double *rays_y,
+                         double *values)
+{
+    int rval = 0;
+
+    for(int j = 0; j < n_rays; j++)
+        values[j] = -INFINITY;
+
+    for(int i = 0; i < n_halfspaces; i++)
+    {
+        const double h0 = halfspaces[2 * i];
+        const double h1 = halfspaces[2 * i + 1];
+
+        #pragma omp simd
+        for(int j = 0; j < n_rays; j++)
+        {
+            double v = rays_x[j] * h0 + rays_y[j] * h1;
+            values[j] = max(v, values[j]);
+        }
+    }
+
+CLEANUP:
+    return rval;
+}
+
+/**
+ * Batch version of LIFTING_2D_lift_fixed. The continuous optimum is linear
+ * in alpha2 on each side of zero, so it is obtained from the slopes
+ * alpha1_plus and alpha1_minus, computed for alpha2 = 1 and alpha2 = -1.
+ */
+static int lift_fixed_batch(int n_halfspaces,
+                            const double *halfspaces,
+                            double alpha1_plus,
+                            double alpha1_minus,
+                            int n_rays,
+                            const double *rays_x,
+                            const double *rays_y,
+                            double k1,
+                            double *opt)
+{
+    int rval = 0;
+
+    double q_ceil[LIFTING_BATCH_SIZE];
+    double q_floor[LIFTING_BATCH_SIZE];
+    double q_y[LIFTING_BATCH_SIZE];
+    double value_floor[LIFTING_BATCH_SIZE];
+
+    #pragma omp simd
+    for(int j = 0; j < n_rays; j++)
+    {
+        double alpha2 = rays_y[j] + k1;
+        double k0 = (alpha2 >= 0 ? alpha2 * alpha1_plus
+                                 : -alpha2 * alpha1_minus);
+        double delta = k0 - rays_x[j];
+
+        q_ceil[j] = rays_x[j] + ceil(delta);
+        q_floor[j] = rays_x[j] + floor(delta);
+        q_y[j] = alpha2;
+    }
+
+    rval = LIFTING_2D_psi_batch(n_halfspaces, halfspaces, n_rays, q_ceil, q_y,
+            opt);
+    abort_if(rval, "LIFTING_2D_psi_batch failed");
+
+    rval = LIFTING_2D_psi_batch(n_halfspaces, halfspaces, n_rays, q_floor,
+            q_y, value_floor);
+    abort_if(rval, "LIFTING_2D_psi_batch failed");
+
+    #pragma omp simd
+    for(int j = 0; j < n_rays; j++)
+        opt[j] = min(opt[j], value_floor[j]);
+
+CLEANUP:
+    return rval;
+}
+
+/**
+ * Batch version of LIFTING_2D_bound. All rays go through the levels k1
+ * together. A ray stops being updated once the stopping condition of
+ * LIFTING_2D_bound holds for it, and the loop ends when this is the case
+ * for all rays of the batch.
+ *
+ * @param[in]  n_halfspaces  number of facets of the lattice-free set
+ * @param[in]  halfspaces    description of the lattice-free set
+ * @param[in]  n_rays        number of rays
+ * @param[in]  rays_x        first coordinate of each ray
+ * @param[in]  rays_y        second coordinate of each ray
+ * @param[out] values        lifted coefficient of each ray
+ */
+int LIFTING_2D_bound_batch(int n_halfspaces,
+                           const double *halfspaces,
+                           int n_rays,
+                           const double *rays_x,
+                           const double *rays_y,
+                           double *values)
+{
+    int rval = 0;
+
+    double xi_plus, xi_minus;
+    double alpha1_plus, alpha1_minus;
+
+    double eta_plus[LIFTING_BATCH_SIZE];
+    double eta_minus[LIFTING_BATCH_SIZE];
+    double m_plus[LIFTING_BATCH_SIZE];
+    double m_minus[LIFTING_BATCH_SIZE];
+    int is_active[LIFTING_BATCH_SIZE];
+
+    rval = LIFTING_2D_optimize_continuous(n_halfspaces, halfspaces, 1,
+            &alpha1_plus, &xi_plus);
+    abort_if(rval, "LIFTING_2D_optimize_continuous failed");
+
+    rval = LIFTING_2D_optimize_continuous(n_halfspaces, halfspaces, -1,
+            &alpha1_minus, &xi_minus);
+    abort_if(rval, "LIFTING_2D_optimize_continuous failed");
+
+    for(int b = 0; b < n_rays; b += LIFTING_BATCH_SIZE)
+    {
+        int n = min(LIFTING_BATCH_SIZE, n_rays - b);
+        const double *x = &rays_x[b];
+        const double *y = &rays_y[b];
+        double *eta_star = &values[b];
+
+        rval = lift_fixed_batch(n_halfspaces, halfspaces, alpha1_plus,
+                alpha1_minus, n, x, y, 0, eta_star);
+        abort_if(rval, "lift_fixed_batch failed");
+
+        for(int j = 0; j < n; j++)
+            m_plus[j] = m_minus[j] = INFINITY;
+
+        for(int k1 = 1; ; k1++)
+        {
+            int n_active = 0;
+
+            for(int j = 0; j < n; j++)
+            {
+                is_active[j] = (k1 <= fabs(y[j])) || (k1 + y[j] <= m_plus[j])
+                        || (k1 - y[j] <= m_minus[j]);
+                n_active += is_active[j];
+            }
+
+            if(n_active == 0) break;
+
+            rval = lift_fixed_batch(n_halfspaces, halfspaces, alpha1_plus,
+                    alpha1_minus, n, x, y, k1, eta_plus);
+            abort_if(rval, "lift_fixed_batch failed");
+
+            rval = lift_fixed_batch(n_halfspaces, halfspaces, alpha1_plus,
+                    alpha1_minus, n, x, y, -k1, eta_minus);
+            abort_if(rval, "lift_fixed_batch failed");
+
+            #pragma omp simd
+            for(int j = 0; j < n; j++)
+            {
+                double eta = min(eta_star[j], min(eta_plus[j], eta_minus[j]));
+
+                eta_star[j] = (is_active[j] ? eta : eta_star[j]);
+                m_plus[j] = (is_active[j] ? ceil(eta / xi_plus) : m_plus[j]);
+                m_minus[j] = (is_active[j] ? ceil(eta / xi_minus) : m_minus[j]);
+            }
+        }
+    }
+
+CLEANUP:
+    return rval;
+}
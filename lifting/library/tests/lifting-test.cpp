@@ -21,6 +21,7 @@ extern "C" {
 #include <multirow/lfree2d.h>
 #include <lifting/lifting.h>
 #include <lifting/lifting-mip.h>
+#include <lifting/lifting-table.h>
 }
 
 #define E 1e-6
@@ -286,6 +287,52 @@ CLEANUP:
     if(rval) FAIL();
 }
 
+TEST(Lifting2DTest, bound_batch_test)
+{
+    int rval = 0;
+
+    int n_halfspaces = 5;
+    double halfspaces[] = {
+            -1 / 2.0, 0,
+            -1 / 2.0, -1 / 2.0,
+            -1 / 4.0, 1 / 2.0,
+            -1 / 6.0, -5 / 6.0,
+            5 / 16.0, 1 / 8.0
+    };
+
+    int n_rays = 4;
+    double rays_x[] = { 1/2.0, 0, 1/3.0, 2/5.0 };
+    double rays_y[] = { 1/2.0, 1/2.0, 2/3.0, 3/7.0 };
+
+    double values[4];
+
+    rval = LIFTING_2D_psi_batch(n_halfspaces, halfspaces, n_rays, rays_x,
+            rays_y, values);
+    abort_if(rval, "LIFTING_2D_psi_batch failed");
+
+    for(int i = 0; i < n_rays; i++)
+    {
+        double ray[] = { rays_x[i], rays_y[i] };
+        double value;
+
+        rval = LIFTING_2D_psi(n_halfspaces, halfspaces, ray, &value);
+        abort_if(rval, "LIFTING_2D_psi failed");
+        EXPECT_NEAR(values[i], value, E);
+    }
+
+    rval = LIFTING_2D_bound_batch(n_halfspaces, halfspaces, n_rays, rays_x,
+            rays_y, values);
+    abort_if(rval, "LIFTING_2D_bound_batch failed");
+
+    EXPECT_NEAR(values[0], 0.21875, E);
+    EXPECT_NEAR(values[1], 0.25, E);
+    EXPECT_NEAR(values[2], 0.222222, E);
+    EXPECT_NEAR(values[3], 0.178571, E);
+
+CLEANUP:
+    if(rval) FAIL();
+}
+
 TEST(Lifting2DTest, mip_test_1)
 {
     int rval = 0;
@@ -326,6 +373,115 @@ TEST(Lifting2DTest, mip_test_1)
     if(rval) FAIL();
 }
 
+TEST(Lifting2DTest, mip_batch_test)
+{
+    int rval = 0;
+
+    int n_halfspaces = 5;
+    double halfspaces[] = {
+            -1 / 2.0, 0,
+            -1 / 2.0, -1 / 2.0,
+            -1 / 4.0, 1 / 2.0,
+            -1 / 6.0, -5 / 6.0,
+            5 / 16.0, 1 / 8.0
+    };
+
+    int n_rays = 4;
+    double rays[] = {
+            1/2.0, 1/2.0,
+            0, 1/2.0,
+            1/3.0, 2/3.0,
+            2/5.0, 3/7.0
+    };
+
+    double values[4];
+
+    rval = LIFTING_2D_mip_batch(n_halfspaces, halfspaces, n_rays, rays,
+            values);
+    abort_if(rval, "LIFTING_2D_mip_batch failed");
+
+    EXPECT_NEAR(values[0], 0.21875, E);
+    EXPECT_NEAR(values[1], 0.25, E);
+    EXPECT_NEAR(values[2], 0.222222, E);
+    EXPECT_NEAR(values[3], 0.178571, E);
+
+    CLEANUP:
+    if(rval) FAIL();
+}
+
+TEST(Lifting2DTest, table_test_1)
+{
+    int rval = 0;
+
+    int n_halfspaces = 5;
+    double halfspaces[] = {
+            -1 / 2.0, 0,
+            -1 / 2.0, -1 / 2.0,
+            -1 / 4.0, 1 / 2.0,
+            -1 / 6.0, -5 / 6.0,
+            5 / 16.0, 1 / 8.0
+    };
+
+    double r1[] = { 1/2.0, 1/2.0 };
+    double r2[] = { 0, 1/2.0 };
+    double r3[] = { 1/3.0, 2/3.0 };
+    double r4[] = { 2/5.0 - 3, 3/7.0 + 2 };
+
+    struct LiftingTable table = {0};
+    double value;
+
+    rval = LIFTING_2D_table_build(n_halfspaces, halfspaces, 4, &table);
+    abort_if(rval, "LIFTING_2D_table_build failed");
+
+    rval = LIFTING_2D_table_query(&table, r1, &value);
+    abort_if(rval, "LIFTING_2D_table_query failed");
+    EXPECT_NEAR(value, 0.21875, E);
+
+    rval = LIFTING_2D_table_query(&table, r2, &value);
+    abort_if(rval, "LIFTING_2D_table_query failed");
+    EXPECT_NEAR(value, 0.25, E);
+
+    rval = LIFTING_2D_table_query(&table, r3, &value);
+    abort_if(rval, "LIFTING_2D_table_query failed");
+    EXPECT_NEAR(value, 0.222222, E);
+
+    rval = LIFTING_2D_table_query(&table, r4, &value);
+    abort_if(rval, "LIFTING_2D_table_query failed");
+    EXPECT_NEAR(value, 0.178571, E);
+
+CLEANUP:
+    LIFTING_2D_table_free(&table);
+    if(rval) FAIL();
+}
+
+TEST(Lifting2DTest, table_test_2)
+{
+    int rval = 0;
+
+    int n_halfspaces = 3;
+    double halfspaces[] = {
+        -1.12796209,  -2.25592417,
+         2.38125329,  11.19606810,
+         7.35264174,   6.22467965,
+    };
+
+    double r[] = { 0.48231629, 0.70551355 };
+
+    struct LiftingTable table = {0};
+    double value;
+
+    rval = LIFTING_2D_table_build(n_halfspaces, halfspaces, 6, &table);
+    abort_if(rval, "LIFTING_2D_table_build failed");
+
+    rval = LIFTING_2D_table_query(&table, r, &value);
+    abort_if(rval, "LIFTING_2D_table_query failed");
+    EXPECT_NEAR(value, 1.24826671, E);
+
+CLEANUP:
+    LIFTING_2D_table_free(&table);
+    if(rval) FAIL();
+}
+
 TEST(Lifting2DTest, verify_test_1)
 {
     int rval = 0;
@@ -19,11 +19,27 @@
 
 #include <multirow/lfree2d.h>
 #include <multirow/lp.h>
+#include <multirow/lu.h>
+
+struct CutPool
+{
+    struct Row *cuts;
+    double *violation;
+    double *dynamism;
+    int ncuts;
+    int capacity;
+};
 
 struct CG
 {
     struct LP *lp;
+    struct LP tableau_lp;
+    struct LP *tableau_copies;
+    int n_tableau_copies;
     struct Row **tableau_rows;
+    int *basis_head;
+    double *basis_values;
+    struct LUTableau *lu_tableau;
     int *cstat;
     int *rstat;
     double *ub;
@@ -37,6 +53,8 @@ struct CG
     double *integral_solution;
     double *basic_solution;
     double *current_solution;
+
+    struct CutPool pool;
 };
 
 struct Tableau
@@ -67,6 +85,7 @@ typedef int (*SingleRowGeneratorCallback)(const struct Row *row,
                                           struct Row *cut);
 
 typedef int (*MultiRowGeneratorCallback)(const struct Tableau *tableau,
+                                         void *context,
                                          struct Row *cut);
 
 int CG_init(struct LP *lp, char *column_types, struct CG *cg);
@@ -75,9 +94,15 @@ void CG_free(struct CG *cg);
 
 int CG_add_single_row_cuts(struct CG *cg, SingleRowGeneratorCallback generate);
 
+/*
+ * Generates and adds multi-row cuts. Cuts are generated concurrently by
+ * N_THREADS threads, and the thread with number t passes contexts[t] to the
+ * generator.
+ */
 int CG_add_multirow_cuts(struct CG *cg,
                          int nrows,
-                         MultiRowGeneratorCallback generate);
+                         MultiRowGeneratorCallback generate,
+                         void **contexts);
 
 int CG_set_integral_solution(struct CG *cg, double *valid_solution);
 
@@ -114,6 +139,8 @@ void CG_free_model(struct MultiRowModel *model);
 
 int CG_total_nz(const struct Tableau *tableau);
 
+int CG_cut_dynamism(struct Row *cut, double *dynamism);
+
 double CG_replace_x(const struct Row *row, const double *x);
 
 int CG_print_model(const struct MultiRowModel *model);
@@ -46,6 +46,9 @@ struct ConvLFreeSet
     struct RayList rays;
     int nrows;
     double *beta;
+
+    int n_halfspaces;
+    double *halfspaces;
 };
 
 int LFREE_2D_init(struct LFreeSet2D *set,
@@ -79,6 +82,8 @@ int LFREE_init_ray_list(struct RayList *list, int dim, int capacity);
 
 int LFREE_init_conv(struct ConvLFreeSet *lfree, int dim, int max_nrays);
 
+int LFREE_compute_conv_halfspaces(struct ConvLFreeSet *lfree);
+
 void LFREE_free_conv(struct ConvLFreeSet *lfree);
 
 int LFREE_print_set(const struct ConvLFreeSet *lfree);
@@ -37,4 +37,16 @@ double LINALG_norm(int n, double *x);
  * function finds x such that Ax = b. Returns zero if the operation is
  * successful and non-zero otherwise.
  */
-int LINALG_solve(int n, int m, double *A, double *b, double *x);
\ No newline at end of file
+int LINALG_solve(int n, int m, double *A, double *b, double *x);
+
+/**
+ * Given an m-by-k matrix H and an n-by-k matrix R, both in row-major order,
+ * sets y_i to the largest entry in the i-th row of R H^T, for every i. Returns
+ * zero if the operation is successful and non-zero otherwise.
+ */
+int LINALG_max_product(int m,
+                       int n,
+                       int k,
+                       const double *H,
+                       const double *R,
+                       double *y);
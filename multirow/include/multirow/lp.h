@@ -51,6 +51,19 @@ int LP_write(struct LP *lp,
 
 void LP_free(struct LP *lp);
 
+int LP_is_open(struct LP *lp);
+
+void LP_destroy(struct LP *lp);
+
+int LP_pool_acquire(struct LP *lp);
+
+void LP_pool_release(struct LP *lp);
+
+void LP_pool_free();
+
+int LP_clone(struct LP *lp,
+             struct LP *clone);
+
 void LP_free_row(struct Row *row);
 
 int LP_new_row(struct LP *lp,
@@ -114,6 +127,53 @@ int LP_relax(struct LP *lp);
 int LP_get_column_types(struct LP *lp,
                         char *column_types);
 
+int LP_get_basis_header(struct LP *lp,
+                        int *head,
+                        double *rhs,
+                        int *cstat,
+                        int *rstat,
+                        double *ub,
+                        double *lb);
+
+int LP_tableau_row_from_dense(int ncols,
+                              const double *pi,
+                              int head,
+                              double rhs,
+                              int *cstat,
+                              double *ub,
+                              double *lb,
+                              struct Row *row);
+
+int LP_get_tableau_row(struct LP *lp,
+                       int index,
+                       int head,
+                       double rhs,
+                       int *cstat,
+                       double *ub,
+                       double *lb,
+                       double *pi,
+                       struct Row *row);
+
+int LP_load_tableau_copies(struct LP *lp,
+                           int ncopies,
+                           int *cstat,
+                           int *rstat,
+                           double *ub,
+                           double *lb,
+                           struct LP *copies);
+
+int LP_get_tableau_rows(struct LP *lp,
+                        int ncopies,
+                        struct LP *copies,
+                        int count,
+                        const int *indices,
+                        const int *head,
+                        const double *rhs,
+                        int *cstat,
+                        double *ub,
+                        double *lb,
+                        struct Row **rows);
+
 int LP_get_tableau(struct LP *lp,
                    struct Row **rows,
                    int *cstat,
@@ -154,6 +214,22 @@ int LP_write_sage_file(struct LP *lp,
 
 int LP_change_rhs(struct LP *lp, int index, double value);
 
+int LP_change_rhs_list(struct LP *lp,
+                       int count,
+                       const int *indices,
+                       const double *values);
+
+int LP_change_coefs(struct LP *lp,
+                    int count,
+                    const int *rows,
+                    const int *cols,
+                    const double *values);
+
+int LP_set_mip_start(struct LP *lp,
+                     int nz,
+                     const int *indices,
+                     const double *values);
+
 int LP_init_row(struct Row *row, int nz_capacity);
 
 #endif
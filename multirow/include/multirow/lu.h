@@ -0,0 +1,115 @@
+/* Copyright (c) 2015-2017 Alinson Xavier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTIROW_LU_H
+#define MULTIROW_LU_H
+
+#include <multirow/lp.h>
+
+/**
+ * Sparse LU factorization of a square matrix B.
+ *
+ * At step p, row pivot_row[p] of the active submatrix is used to eliminate
+ * column pivot_col[p] from the remaining rows. Row p of U holds the
+ * off-diagonal entries of the pivot row at that step, while column p of L
+ * holds the multipliers of the rows that were eliminated.
+ */
+struct LU
+{
+    int n;
+
+    int *pivot_row;
+    int *pivot_col;
+
+    double *u_pivot;
+    int *u_start;
+    int *u_indices;
+    double *u_values;
+
+    int *l_start;
+    int *l_rows;
+    double *l_values;
+};
+
+/**
+ * Simplex tableau computed from an LU factorization of the basis, instead of
+ * by CPLEX. Holds a row-wise copy of the constraint matrix.
+ */
+struct LUTableau
+{
+    int nrows;
+    int ncols;
+
+    int *row_start;
+    int *indices;
+    double *values;
+
+    struct LU lu;
+};
+
+/**
+ * Factors the n-by-n matrix B, given in compressed sparse row format. Returns
+ * non-zero if the matrix is singular.
+ */
+int LU_factor(int n,
+              const int *row_start,
+              const int *indices,
+              const double *values,
+              struct LU *lu);
+
+void LU_free(struct LU *lu);
+
+/**
+ * Solves the system B^T y = b. The vector b is overwritten.
+ */
+void LU_solve_transposed(const struct LU *lu, double *b, double *y);
+
+/**
+ * Reads the constraint matrix of the given problem and factors its basis,
+ * whose header is given by head, as returned by CPXgetbhead.
+ */
+int LU_tableau_init(struct LP *lp,
+                    const int *head,
+                    struct LUTableau *tableau);
+
+void LU_tableau_free(struct LUTableau *tableau);
+
+/**
+ * Computes the dense tableau row e_index^T B^-1 A. Arrays work and y must
+ * have nrows entries, and pi must have ncols entries.
+ */
+void LU_tableau_row(const struct LUTableau *tableau,
+                    int index,
+                    double *work,
+                    double *y,
+                    double *pi);
+
+/**
+ * Computes, using nthreads threads, the tableau rows given by indices, in
+ * the same format as LP_get_tableau_rows.
+ */
+int LU_tableau_rows(const struct LUTableau *tableau,
+                    int nthreads,
+                    int count,
+                    const int *indices,
+                    const int *head,
+                    const double *rhs,
+                    int *cstat,
+                    double *ub,
+                    double *lb,
+                    struct Row **rows);
+
+#endif
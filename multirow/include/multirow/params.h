@@ -39,9 +39,9 @@
 #define MAX_BOX_SIZE 1000
 
 /*
- * Maximum number of sets that should be considered
+ * Number of sets read and benchmarked together by the lifting benchmark
  */
-#define MAX_N_SETS 1000
+#define N_SETS_PER_CHUNK 1000
 
 /*
  * Number of rays that should be generated per set.
@@ -68,19 +68,84 @@
 
 #define INFINITY_BIG_E 1024
 
+/*
+ * Maximum number of vertex subsets enumerated when computing the facets of a
+ * lattice-free set with more than three rows. For larger sets, psi is
+ * evaluated by solving LPs.
+ */
+#define MAX_FACET_SUBSETS 200000
+
+/*
+ * Integer translates q + k, with k in [-MAX_LIFTING_RADIUS,
+ * MAX_LIFTING_RADIUS]^n, are considered when lifting a cut coefficient.
+ */
+#define MAX_LIFTING_RADIUS 2
+
+/*
+ * Maximum depth of the quadtree built by LIFTING_2D_table_build.
+ */
+#define LIFTING_TABLE_DEPTH 4
+
+/*
+ * Lattice points interior to a lattice-free set are first searched by
+ * enumeration, for models with MIN_ENUM_ROWS to MAX_ENUM_ROWS rows. At most
+ * MAX_ENUM_POINTS points are evaluated before falling back to a MIP. With
+ * more than three rows, the facets needed by the enumeration are found by
+ * visiting subsets of rays, so the MIP is used directly when there are more
+ * than MAX_ENUM_FACET_SUBSETS of them.
+ */
+#define MIN_ENUM_ROWS 2
+#define MAX_ENUM_ROWS 5
+#define MAX_ENUM_POINTS 4096
+#define MAX_ENUM_FACET_SUBSETS 2000
+
 #define MAX_CUT_DYNAMISM 1e8
 #define INTEGRALITY_THRESHOLD 0.49
 
+/*
+ * Number of row combinations handed to each thread, per batch, during
+ * multi-row cut generation.
+ */
+#define CG_WINDOW_SIZE 16
+
+/*
+ * Policies for choosing which cuts in the pool are added to the LP.
+ */
+#define CUT_SELECTION_VIOLATION 0
+#define CUT_SELECTION_DYNAMISM 1
+
+/*
+ * Engines for computing rows of the simplex tableau.
+ */
+#define TABLEAU_ENGINE_CPLEX 0
+#define TABLEAU_ENGINE_LU 1
+
+/*
+ * Algorithms for computing lattice-free sets from two-row models. The
+ * validation mode runs both algorithms and compares their results.
+ */
+#define LFREE_2D_ALGORITHM_ND 0
+#define LFREE_2D_ALGORITHM_FAST 1
+#define LFREE_2D_ALGORITHM_VALIDATE 2
+
 extern int BOOST_VAR;
 extern double BOOST_FACTOR;
-extern int SHOULD_DUMP_CUTS;
-extern int DUMP_CUT_N;
 
 extern int ENABLE_LIFTING;
 extern int MIN_N_ROWS;
 extern int MAX_N_ROWS;
 
+extern int N_THREADS;
+
+extern int CUT_POOL_SIZE;
+extern int CUT_BATCH_SIZE;
+extern int CUT_SELECTION;
+
+extern int TABLEAU_ENGINE;
+extern int LFREE_2D_ALGORITHM;
+
 #define ERR_NO_CUT 2
 #define ERR_MIP_TIMEOUT 3
+#define ERR_TABLE_TOO_LARGE 4
 
 #endif //PROJECT_PARAMS_H
@@ -26,6 +26,14 @@ void STATS_increment_generated_cuts();
 
 void STATS_increment_added_cuts();
 
+void STATS_increment_pooled_cuts();
+
+void STATS_increment_lp_solves();
+
+void STATS_add_lfree_2d_validation(double nd_time, double fast_time, int agree);
+
+void STATS_add_lfree_cache_lookup(int hit);
+
 int STATS_print_yaml(char *filename);
 
 void STATS_finish_round();
@@ -84,6 +84,8 @@ void time_printf(const char *fmt,
 
 double get_user_time(void);
 
+double get_thread_time(void);
+
 double get_real_time();
 
 double frac(double x);
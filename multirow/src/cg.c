@@ -16,6 +16,7 @@
 
 #include <stdlib.h>
 #include <math.h>
+#include <omp.h>
 
 #include <multirow/params.h>
 #include <multirow/cg.h>
@@ -34,15 +35,15 @@ static int select_rows(struct CG *cg, int *row_selected)
     for (int i = 0; i < cg->nrows; i++)
     {
         row_selected[i] = 1;
-        struct Row *r1 = cg->tableau_rows[i];
+        int head = cg->basis_head[i];
 
-        if (r1->head < 0 || cg->column_types[r1->head] != MILP_INTEGER)
+        if (head < 0 || cg->column_types[head] != MILP_INTEGER)
         {
             row_selected[i] = 0;
             continue;
         }
 
-        double dist = fabs(0.5 - frac(r1->pi_zero));
+        double dist = fabs(0.5 - frac(cg->basis_values[i]));
         for (int k = 0; k < 100; k++)
             if (dist <= (k / 100.0))
                 histogram[k]++;
@@ -63,8 +64,7 @@ static int select_rows(struct CG *cg, int *row_selected)
     {
         if (!row_selected[i]) continue;
 
-        struct Row *r1 = cg->tableau_rows[i];
-        double dist = fabs(0.5 - frac(r1->pi_zero));
+        double dist = fabs(0.5 - frac(cg->basis_values[i]));
 
         if (dist > dist_cutoff || selected_count >= MAX_SELECTED_ROWS)
         {
@@ -268,11 +268,254 @@ CLEANUP:
     return rval;
 }
 
+/*
+ * Auxiliary structure for ranking the cuts in the pool.
+ */
+struct CutRank
+{
+    double primary;
+    double secondary;
+    int index;
+};
+
+static int _qsort_cmp_cut_rank(const void *p1, const void *p2)
+{
+    const struct CutRank *r1 = (const struct CutRank *) p1;
+    const struct CutRank *r2 = (const struct CutRank *) p2;
+
+    if (r1->primary != r2->primary)
+        return (r1->primary > r2->primary ? -1 : 1);
+
+    if (r1->secondary != r2->secondary)
+        return (r1->secondary > r2->secondary ? -1 : 1);
+
+    return r1->index - r2->index;
+}
+
+static int pool_init(struct CutPool *pool, int capacity)
+{
+    int rval = 0;
+
+    pool->ncuts = 0;
+    pool->capacity = capacity;
+
+    pool->cuts = (struct Row *) malloc(capacity * sizeof(struct Row));
+    pool->violation = (double *) malloc(capacity * sizeof(double));
+    pool->dynamism = (double *) malloc(capacity * sizeof(double));
+    abort_if(!pool->cuts, "could not allocate pool->cuts");
+    abort_if(!pool->violation, "could not allocate pool->violation");
+    abort_if(!pool->dynamism, "could not allocate pool->dynamism");
+
+CLEANUP:
+    return rval;
+}
+
+static void pool_clear(struct CutPool *pool)
+{
+    for (int i = 0; i < pool->ncuts; i++)
+        LP_free_row(&pool->cuts[i]);
+
+    pool->ncuts = 0;
+}
+
+static void pool_free(struct CutPool *pool)
+{
+    if (!pool->cuts) return;
+    pool_clear(pool);
+    free(pool->cuts);
+    free(pool->violation);
+    free(pool->dynamism);
+}
+
+static double cut_norm(const struct Row *cut)
+{
+    double norm = 0;
+
+    for (int i = 0; i < cut->nz; i++)
+        norm += cut->pi[i] * cut->pi[i];
+
+    return sqrt(norm);
+}
+
+/*
+ * Stores a copy of the given cut in the pool. The violation of the cut is
+ * normalized by its euclidean norm, which must be positive.
+ */
+static int pool_push(struct CutPool *pool,
+                     const struct Row *cut,
+                     double lhs,
+                     double norm)
+{
+    int rval = 0;
+    struct Row *copy = &pool->cuts[pool->ncuts];
+
+    abort_if(pool->ncuts >= pool->capacity, "cut pool is full");
+
+    rval = LP_init_row(copy, max(cut->nz, 1));
+    abort_if(rval, "LP_init_row failed");
+
+    copy->nz = cut->nz;
+    copy->head = cut->head;
+    copy->pi_zero = cut->pi_zero;
+    memcpy(copy->pi, cut->pi, cut->nz * sizeof(double));
+    memcpy(copy->indices, cut->indices, cut->nz * sizeof(int));
+
+    pool->violation[pool->ncuts] = (lhs - cut->pi_zero) / norm;
+
+    rval = CG_cut_dynamism(copy, &pool->dynamism[pool->ncuts]);
+    abort_if(rval, "CG_cut_dynamism failed");
+
+    pool->ncuts++;
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Sorts the cuts in the pool, from the most preferred to the least preferred,
+ * according to the given selection policy. Ties are broken by the order in
+ * which the cuts were added to the pool.
+ */
+static int pool_rank(const struct CutPool *pool, int policy, int *order)
+{
+    int rval = 0;
+    struct CutRank *ranks = 0;
+
+    ranks = (struct CutRank *) malloc(pool->ncuts * sizeof(struct CutRank));
+    abort_if(!ranks, "could not allocate ranks");
+
+    for (int i = 0; i < pool->ncuts; i++)
+    {
+        ranks[i].index = i;
+
+        switch (policy)
+        {
+        case CUT_SELECTION_DYNAMISM:
+            ranks[i].primary = -pool->dynamism[i];
+            ranks[i].secondary = pool->violation[i];
+            break;
+
+        case CUT_SELECTION_VIOLATION:
+            ranks[i].primary = pool->violation[i];
+            ranks[i].secondary = -pool->dynamism[i];
+            break;
+
+        default:
+            abort_iff(1, "invalid cut selection policy (%d)", policy);
+        }
+    }
+
+    qsort(ranks, (size_t) pool->ncuts, sizeof(struct CutRank),
+            _qsort_cmp_cut_rank);
+
+    for (int i = 0; i < pool->ncuts; i++)
+        order[i] = ranks[i].index;
+
+CLEANUP:
+    if (ranks) free(ranks);
+    return rval;
+}
+
+/*
+ * Adds the best cuts in the pool to the LP, using a single call to
+ * LP_add_rows, and reoptimizes. The remaining cuts are discarded.
+ */
+static int flush_cut_pool(struct CG *cg)
+{
+    int rval = 0;
+    struct CutPool *pool = &cg->pool;
+
+    int *order = 0;
+    double *rhs = 0;
+    char *sense = 0;
+    int *rmatbeg = 0;
+    int *rmatind = 0;
+    double *rmatval = 0;
+
+    int nselected, nz = 0;
+    int infeasible;
+    double obj;
+
+    if (pool->ncuts == 0) goto CLEANUP;
+
+    nselected = min(pool->ncuts, CUT_BATCH_SIZE);
+
+    order = (int *) malloc(pool->ncuts * sizeof(int));
+    abort_if(!order, "could not allocate order");
+
+    rval = pool_rank(pool, CUT_SELECTION, order);
+    abort_if(rval, "pool_rank failed");
+
+    for (int k = 0; k < nselected; k++)
+        nz += pool->cuts[order[k]].nz;
+
+    rhs = (double *) malloc(nselected * sizeof(double));
+    sense = (char *) malloc(nselected * sizeof(char));
+    rmatbeg = (int *) malloc(nselected * sizeof(int));
+    rmatind = (int *) malloc(max(nz, 1) * sizeof(int));
+    rmatval = (double *) malloc(max(nz, 1) * sizeof(double));
+    abort_if(!rhs, "could not allocate rhs");
+    abort_if(!sense, "could not allocate sense");
+    abort_if(!rmatbeg, "could not allocate rmatbeg");
+    abort_if(!rmatind, "could not allocate rmatind");
+    abort_if(!rmatval, "could not allocate rmatval");
+
+    nz = 0;
+    for (int k = 0; k < nselected; k++)
+    {
+        struct Row *cut = &pool->cuts[order[k]];
+
+        rhs[k] = cut->pi_zero;
+        sense[k] = 'L';
+        rmatbeg[k] = nz;
+
+        memcpy(&rmatind[nz], cut->indices, cut->nz * sizeof(int));
+        memcpy(&rmatval[nz], cut->pi, cut->nz * sizeof(double));
+        nz += cut->nz;
+    }
+
+    log_verbose("Adding %d cuts (%d discarded)...\n", nselected,
+            pool->ncuts - nselected);
+
+    rval = LP_add_rows(cg->lp, nselected, nz, rhs, sense, rmatbeg, rmatind,
+            rmatval);
+    abort_if(rval, "LP_add_rows failed");
+
+    log_verbose("Reoptimizing...\n");
+    rval = LP_optimize(cg->lp, &infeasible);
+    abort_if(rval, "LP_optimize failed");
+
+    rval = LP_get_obj_val(cg->lp, &obj);
+    abort_if(rval, "LP_get_obj_val failed");
+
+    if (DOUBLE_neq(obj, cg->last_obj_value))
+        log_info("    opt = %lf\n", obj);
+
+    cg->last_obj_value = obj;
+
+    rval = LP_get_x(cg->lp, cg->current_solution);
+    abort_if(rval, "LP_get_x failed");
+
+    for (int k = 0; k < nselected; k++)
+        STATS_increment_added_cuts();
+
+    STATS_increment_lp_solves();
+
+CLEANUP:
+    pool_clear(pool);
+    if (rmatval) free(rmatval);
+    if (rmatind) free(rmatind);
+    if (rmatbeg) free(rmatbeg);
+    if (sense) free(sense);
+    if (rhs) free(rhs);
+    if (order) free(order);
+    return rval;
+}
+
 static int add_cut(struct CG *cg, struct Row *cut, int *ignored)
 {
     int rval;
-    double *x = 0;
-    double lhs;
+    double lhs, norm;
 
     rval = LP_unflip_row_coefficients(cg->cstat, cg->lb, cg->ub, cut);
     abort_if(rval, "LP_unflip_row_coefficients failed");
@@ -281,150 +524,755 @@ static int add_cut(struct CG *cg, struct Row *cut, int *ignored)
     abort_if(rval, "check_cut failed");
 
     lhs = CG_replace_x(cut, cg->current_solution);
+    norm = cut_norm(cut);
 
     *ignored = 0;
     STATS_increment_generated_cuts();
 
-    if (DOUBLE_leq(lhs, cut->pi_zero))
+    if (DOUBLE_leq(lhs, cut->pi_zero))
+    {
+        log_verbose("Ignoring cut (%12.8lf <= %12.8lf)\n", lhs, cut->pi_zero);
+        *ignored = 1;
+    }
+    else if (norm <= EPSILON)
+    {
+        log_verbose("Ignoring cut with zero norm\n");
+        *ignored = 1;
+    }
+    else
+    {
+        rval = pool_push(&cg->pool, cut, lhs, norm);
+        abort_if(rval, "pool_push failed");
+
+        STATS_increment_pooled_cuts();
+
+        if (cg->pool.ncuts >= cg->pool.capacity)
+        {
+            rval = flush_cut_pool(cg);
+            abort_if(rval, "flush_cut_pool failed");
+        }
+    }
+
+CLEANUP:
+    return rval;
+}
+
+static void dump_row(FILE *file, const struct Row *row, int k)
+{
+    fprintf(file, "double pi%d[] = { ", k);
+    for(int i = 0; i < row->nz; i++)
+        fprintf(file, "%.10lf, ", row->pi[i]);
+    fprintf(file, "};\n");
+
+    fprintf(file, "int indices%d[] = { ", k);
+    for(int i = 0; i < row->nz; i++)
+        fprintf(file, "%d, ", row->indices[i]);
+    fprintf(file, "};\n");
+
+    fprintf(file, "struct Row row%d = {", k);
+    fprintf(file, ".nz = %d, ", row->nz);
+    fprintf(file, ".head = %d, ", row->head);
+    fprintf(file, ".pi_zero = %.10lf, ", row->pi_zero);
+    fprintf(file, ".pi = pi%d, ", k);
+    fprintf(file, ".indices = indices%d };\n", k);
+}
+
+static void dump_cut(const struct Row *cut, long count)
+{
+    char filename[100];
+    sprintf(filename, "cut-%03ld.c", count);
+
+    log_info("Dumping generated cut to file %s\n", filename);
+
+    FILE *file = fopen(filename, "w");
+    dump_row(file, cut, 0);
+    fclose(file);
+}
+
+static void dump_tableau(const struct Tableau *tableau, long count)
+{
+    char filename[100];
+    sprintf(filename, "tableau-%03ld.c", count);
+
+    log_info("Dumping tableau to file %s\n", filename);
+
+    FILE *file = fopen(filename, "w");
+
+    for(int i = 0; i < tableau->nrows; i++)
+        dump_row(file, tableau->rows[i], i);
+
+    fprintf(file, "struct Row* rows[] = {");
+    for(int i = 0; i < tableau->nrows; i++)
+        fprintf(file, "&row%d, ", i);
+    fprintf(file, "};\n");
+
+    fprintf(file, "char column_types[] = {");
+    for(int i = 0; i < tableau->ncols; i++)
+        fprintf(file, "%d, ", tableau->column_types[i]);
+    fprintf(file, "};\n");
+
+    fprintf(file, "struct Tableau tableau = {");
+    fprintf(file, ".ncols = %d, ", tableau->ncols);
+    fprintf(file, ".nrows = %d, ", tableau->nrows);
+    fprintf(file, ".rows = rows, ");
+    fprintf(file, ".column_types = column_types };\n");
+
+    fclose(file);
+}
+
+static void dump_integral_solution(const struct CG *cg, long count)
+{
+    char filename[100];
+    sprintf(filename, "solution-%03ld.c", count);
+
+    log_info("Dumping integral solution to file %s\n", filename);
+
+    FILE *file = fopen(filename, "w");
+    double *x = cg->integral_solution;
+
+    fprintf(file, "x[%d] = {", cg->ncols);
+    for(int i = 0; i < cg->ncols; i++)
+        fprintf(file, "%.10lf, ", x[i]);
+    fprintf(file, "};\n");
+
+    fclose(file);
+}
+
+/*
+ * Generates the cut corresponding to a single combination of tableau rows.
+ * Only reads the tableau, so that different combinations can be processed
+ * concurrently. The cut must be freed by the caller, even if generation
+ * fails.
+ */
+static int generate_multirow_cut(const struct CG *cg,
+                                 int nrows,
+                                 const int *row_indices,
+                                 struct Row **rows,
+                                 MultiRowGeneratorCallback generate,
+                                 void *context,
+                                 struct Row *cut)
+{
+    int rval = 0;
+    double initial_time, elapsed_time;
+
+    for (int i = 0; i < nrows; i++)
+        rows[i] = cg->tableau_rows[row_indices[i]];
+
+    struct Tableau tableau =
+    {
+            .ncols = cg->ncols,
+            .nrows = nrows,
+            .rows = rows,
+            .column_types = cg->column_types
+    };
+
+    if_verbose_level
+    {
+        time_printf("Generating cut from [ ");
+        for (int i = 0; i < nrows; i++)
+            printf("%d ", row_indices[i]);
+        printf("]...\n");
+    }
+
+    int max_nz = CG_total_nz(&tableau);
+
+    rval = LP_init_row(cut, max_nz);
+    abort_if(rval, "LP_init_row failed");
+
+    initial_time = get_thread_time();
+
+    rval = generate(&tableau, context, cut);
+    if (rval == ERR_NO_CUT) goto CLEANUP;
+    abort_if(rval, "generate failed");
+
+    elapsed_time = get_thread_time() - initial_time;
+    log_verbose("    generate: %.2lf ms\n", elapsed_time * 1000);
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Affinity between pairs of selected rows, defined as the number of cutoffs
+ * that do not exceed the score of the pair. Only the upper triangle of the
+ * matrix is stored, with one byte per pair, and each pair is scored only
+ * when it is first needed.
+ */
+struct RowAffinity
+{
+    const struct CG *cg;
+    int nselected;
+    const int *selected;
+    int ncutoffs;
+    const double *cutoffs;
+    unsigned char *levels;
+};
+
+#define AFFINITY_UNKNOWN 255
+
+/*
+ * State of the search for combinations of tableau rows. Combinations are
+ * cliques of the graph whose vertices are the selected rows and whose edges
+ * connect pairs of rows with affinity at least min_affinity.
+ */
+struct CliqueSearch
+{
+    int nrows;
+    int nselected;
+    const int *selected;
+    const int *is_fractional;
+    struct RowAffinity *affinity;
+
+    int min_affinity;
+    int max_affinity;
+    int *clique;
+    int finished;
+
+    /* counting mode */
+    long *histogram;
+    long count;
+
+    /* enumeration mode */
+    int *combinations;
+    long ncombinations;
+};
+
+static int affinity_init(struct RowAffinity *affinity,
+                         const struct CG *cg,
+                         int nselected,
+                         const int *selected,
+                         int ncutoffs,
+                         const double *cutoffs)
+{
+    int rval = 0;
+    long npairs = (long) nselected * (nselected - 1) / 2;
+
+    affinity->cg = cg;
+    affinity->nselected = nselected;
+    affinity->selected = selected;
+    affinity->ncutoffs = ncutoffs;
+    affinity->cutoffs = cutoffs;
+
+    abort_if(ncutoffs >= AFFINITY_UNKNOWN, "too many cutoffs");
+
+    affinity->levels = (unsigned char *) malloc(max(npairs, 1));
+    abort_if(!affinity->levels, "could not allocate affinity->levels");
+
+    memset(affinity->levels, AFFINITY_UNKNOWN, npairs);
+
+CLEANUP:
+    return rval;
+}
+
+static void affinity_free(struct RowAffinity *affinity)
+{
+    if (affinity->levels) free(affinity->levels);
+}
+
+/*
+ * Returns the affinity between the i-th and the j-th selected rows, scoring
+ * the pair if it has not been scored before.
+ */
+static int affinity_get(struct RowAffinity *affinity, int i, int j, int *level)
+{
+    int rval = 0;
+    int n = affinity->nselected;
+
+    if (i > j) swap(i, j, int);
+
+    long k = (long) i * (2 * n - i - 1) / 2 + (j - i - 1);
+
+    if (affinity->levels[k] == AFFINITY_UNKNOWN)
+    {
+        struct Row *row1 = affinity->cg->tableau_rows[affinity->selected[i]];
+        struct Row *row2 = affinity->cg->tableau_rows[affinity->selected[j]];
+        double score;
+
+        rval = evaluate_row_pair(row1, row2, &score);
+        abort_if(rval, "evaluate_row_pair failed");
+
+        log_verbose("%4d %4d %.2lf\n", affinity->selected[i],
+                affinity->selected[j], score);
+
+        int a = 0;
+        while (a < affinity->ncutoffs && score >= affinity->cutoffs[a]) a++;
+
+        affinity->levels[k] = (unsigned char) a;
+    }
+
+    *level = affinity->levels[k];
+
+CLEANUP:
+    return rval;
+}
+
+static void visit_clique(struct CliqueSearch *search, int strength)
+{
+    int nrows = search->nrows;
+    int valid = 0;
+
+    if (strength < search->min_affinity) return;
+
+    for (int i = 0; i < nrows; i++)
+        if (search->is_fractional[search->clique[i]]) valid = 1;
+
+    if (!valid) return;
+
+    if (search->histogram)
+    {
+        search->histogram[strength]++;
+        search->count++;
+
+        while (search->count >= MAX_SELECTED_COMBINATIONS)
+        {
+            if (search->min_affinity == search->max_affinity)
+            {
+                search->finished = 1;
+                break;
+            }
+
+            search->count -= search->histogram[search->min_affinity];
+            search->min_affinity++;
+        }
+    }
+    else
+    {
+        search->count++;
+
+        if_debug_level if (ONLY_CUT > 0 && search->count != ONLY_CUT)
+                return;
+
+        int *combination =
+                &search->combinations[search->ncombinations * nrows];
+
+        for (int i = 0; i < nrows; i++)
+            combination[i] = search->selected[search->clique[nrows - i - 1]];
+
+        search->ncombinations++;
+
+        if (search->ncombinations >= MAX_SELECTED_COMBINATIONS)
+            search->finished = 1;
+    }
+}
+
+/*
+ * Visits, in lexicographical order, all cliques of size search->nrows that
+ * extend the first depth rows of search->clique.
+ */
+static int find_cliques(struct CliqueSearch *search,
+                        int depth,
+                        int start,
+                        int strength)
+{
+    int rval = 0;
+    int n = search->nselected;
+
+    if (depth == search->nrows)
+    {
+        visit_clique(search, strength);
+        goto CLEANUP;
+    }
+
+    for (int v = start; v <= n - search->nrows + depth; v++)
+    {
+        int v_strength = strength;
+
+        if (search->finished) break;
+
+        for (int d = 0; d < depth; d++)
+        {
+            int a;
+
+            rval = affinity_get(search->affinity, search->clique[d], v, &a);
+            abort_if(rval, "affinity_get failed");
+
+            v_strength = min(v_strength, a);
+            if (v_strength < search->min_affinity) break;
+        }
+
+        if (v_strength < search->min_affinity) continue;
+
+        search->clique[depth] = v;
+
+        rval = find_cliques(search, depth + 1, v + 1, v_strength);
+        abort_if(rval, "find_cliques failed");
+    }
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Finds the combinations of tableau rows that should be used to generate
+ * multi-row cuts. Among the cutoffs 0.05, 0.10, ..., chooses the smallest
+ * one for which fewer than MAX_SELECTED_COMBINATIONS combinations have all
+ * pairwise scores above the cutoff. The combinations are counted in a single
+ * pass over the cliques of the affinity graph, which is pruned as soon as a
+ * cutoff is known to be too small.
+ */
+static int find_combinations(const struct CG *cg,
+                             int nrows,
+                             const int *row_selected,
+                             int *combinations,
+                             long *ncombinations)
+{
+    int rval = 0;
+
+    int ncutoffs = 0;
+    double cutoffs[100];
+
+    int nselected = 0;
+    int *selected = 0;
+    int *is_fractional = 0;
+    int *clique = 0;
+    long histogram[101] = {0};
+
+    struct RowAffinity affinity;
+    struct CliqueSearch search;
+
+    affinity.levels = 0;
+
+    for (double cutoff = 0.05; cutoff <= 1.0; cutoff += 0.05)
+        cutoffs[ncutoffs++] = cutoff;
+
+    *ncombinations = 0;
+
+    for (int i = 0; i < cg->nrows; i++)
+        if (row_selected[i])
+            nselected++;
+
+    if (nselected < nrows) goto CLEANUP;
+
+    selected = (int *) malloc(nselected * sizeof(int));
+    abort_if(!selected, "could not allocate selected");
+
+    nselected = 0;
+    for (int i = 0; i < cg->nrows; i++)
+        if (row_selected[i])
+            selected[nselected++] = i;
+
+    is_fractional = (int *) malloc(nselected * sizeof(int));
+    clique = (int *) malloc(nrows * sizeof(int));
+    abort_if(!is_fractional, "could not allocate is_fractional");
+    abort_if(!clique, "could not allocate clique");
+
+    for (int i = 0; i < nselected; i++)
+    {
+        struct Row *r = cg->tableau_rows[selected[i]];
+        double df = fabs(frac(r->pi_zero) - 0.5);
+        is_fractional[i] = (df < INTEGRALITY_THRESHOLD);
+    }
+
+    rval = affinity_init(&affinity, cg, nselected, selected, ncutoffs,
+            cutoffs);
+    abort_if(rval, "affinity_init failed");
+
+    search.nrows = nrows;
+    search.nselected = nselected;
+    search.selected = selected;
+    search.affinity = &affinity;
+    search.is_fractional = is_fractional;
+    search.min_affinity = 1;
+    search.max_affinity = ncutoffs;
+    search.clique = clique;
+    search.finished = 0;
+    search.histogram = histogram;
+    search.count = 0;
+    search.combinations = 0;
+    search.ncombinations = 0;
+
+    rval = find_cliques(&search, 0, 0, ncutoffs);
+    abort_if(rval, "find_cliques failed");
+
+    log_info("    %8ld combinations [%.2lf]\n", search.count,
+            cutoffs[search.min_affinity - 1]);
+
+    search.finished = 0;
+    search.histogram = 0;
+    search.count = 0;
+    search.combinations = combinations;
+
+    rval = find_cliques(&search, 0, 0, ncutoffs);
+    abort_if(rval, "find_cliques failed");
+
+    if (search.count >= MAX_SELECTED_COMBINATIONS)
+        log_info("    maximum number of combinations reached. stopping.\n");
+
+    *ncombinations = search.ncombinations;
+
+CLEANUP:
+    affinity_free(&affinity);
+    if (clique) free(clique);
+    if (is_fractional) free(is_fractional);
+    if (selected) free(selected);
+    return rval;
+}
+
+/*
+ * Makes sure that at least ncopies copies of tableau_lp are loaded. Copies
+ * are kept until CG_free, so that the problem is copied at most once per
+ * thread and per round, no matter how many times rows are extracted.
+ */
+static int load_tableau_copies(struct CG *cg, int ncopies)
+{
+    int rval = 0;
+    int loaded = cg->n_tableau_copies;
+    struct LP *copies = 0;
+
+    if (ncopies <= loaded) goto CLEANUP;
+
+    copies = (struct LP *) realloc(cg->tableau_copies,
+            ncopies * sizeof(struct LP));
+    abort_if(!copies, "could not allocate tableau_copies");
+
+    cg->tableau_copies = copies;
+
+    rval = LP_load_tableau_copies(&cg->tableau_lp, ncopies - loaded,
+            cg->cstat, cg->rstat, cg->ub, cg->lb, &copies[loaded]);
+    abort_if(rval, "LP_load_tableau_copies failed");
+
+    cg->n_tableau_copies = ncopies;
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Computes the given tableau rows using the selected tableau engine.
+ */
+static int extract_tableau_rows(struct CG *cg,
+                                int nthreads,
+                                int count,
+                                const int *indices,
+                                struct Row **rows)
+{
+    int rval = 0;
+    int ncopies = min(nthreads, count) - 1;
+
+    if (cg->lu_tableau)
+    {
+        rval = LU_tableau_rows(cg->lu_tableau, nthreads, count, indices,
+                cg->basis_head, cg->basis_values, cg->cstat, cg->ub, cg->lb,
+                rows);
+        abort_if(rval, "LU_tableau_rows failed");
+        goto CLEANUP;
+    }
+
+    rval = load_tableau_copies(cg, ncopies);
+    abort_if(rval, "load_tableau_copies failed");
+
+    rval = LP_get_tableau_rows(&cg->tableau_lp, max(ncopies, 0),
+            cg->tableau_copies, count, indices, cg->basis_head,
+            cg->basis_values, cg->cstat, cg->ub, cg->lb, rows);
+    abort_if(rval, "LP_get_tableau_rows failed");
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Extracts, using N_THREADS threads, the selected tableau rows that have not
+ * been extracted yet.
+ */
+static int prefetch_tableau_rows(struct CG *cg, const int *row_selected)
+{
+    int rval = 0;
+    int count = 0;
+
+    int *indices = 0;
+    struct Row **rows = 0;
+
+    indices = (int *) malloc(cg->nrows * sizeof(int));
+    abort_if(!indices, "could not allocate indices");
+
+    for (int i = 0; i < cg->nrows; i++)
+        if (row_selected[i] && !cg->tableau_rows[i])
+            indices[count++] = i;
+
+    if (count == 0) goto CLEANUP;
+
+    rows = (struct Row **) calloc(count, sizeof(struct Row *));
+    abort_if(!rows, "could not allocate rows");
+
+    for (int k = 0; k < count; k++)
+    {
+        rows[k] = (struct Row *) malloc(sizeof(struct Row));
+        abort_if(!rows[k], "could not allocate rows[k]");
+        rows[k]->pi = 0;
+        rows[k]->indices = 0;
+    }
+
+    rval = extract_tableau_rows(cg, N_THREADS, count, indices, rows);
+    abort_if(rval, "extract_tableau_rows failed");
+
+    for (int k = 0; k < count; k++)
+    {
+        cg->tableau_rows[indices[k]] = rows[k];
+        rows[k] = 0;
+    }
+
+CLEANUP:
+    if (rows)
+    {
+        for (int k = 0; k < count; k++)
+        {
+            if (!rows[k]) continue;
+            LP_free_row(rows[k]);
+            free(rows[k]);
+        }
+        free(rows);
+    }
+    if (indices) free(indices);
+    return rval;
+}
+
+#ifndef TEST_SOURCE
+
+double CG_replace_x(const struct Row *row, const double *x)
+{
+    double lhs = 0;
+    double *terms = (double*) malloc(row->nz * sizeof(double));
+
+    for (int i = 0; i < row->nz; i++)
     {
-        log_verbose("Ignoring cut (%12.8lf <= %12.8lf)\n", lhs, cut->pi_zero);
-        *ignored = 1;
+        double pii = row->pi[i];
+        int idx = row->indices[i];
+        terms[i] = pii * x[idx];
     }
-    else
-    {
-        rval = LP_add_row(cg->lp, cut);
-        abort_if(rval, "LP_add_row failed");
 
-        int infeasible;
-        log_verbose("Reoptimizing...\n");
-        rval = LP_optimize(cg->lp, &infeasible);
-        abort_if(rval, "LP_optimize failed");
-
-        double obj;
-        rval = LP_get_obj_val(cg->lp, &obj);
-        abort_if(rval, "LP_get_obj_val failed");
+    DOUBLE_sum(terms, row->nz, &lhs);
 
-        if (DOUBLE_neq(obj, cg->last_obj_value))
-            log_info("    opt = %lf\n", obj);
+    free(terms);
+    return lhs;
+}
 
-        cg->last_obj_value = obj;
+/*
+ * Step used to quantize the components of normalized rays. Parallel rays
+ * whose components round differently are not merged, which only means that
+ * their cut coefficients are computed separately.
+ */
+#define RAY_HASH_STEP 1e-6
 
-        x = (double *) malloc(cg->ncols * sizeof(double));
-        abort_if(!x, "could not allocate x");
+/*
+ * Hash table of the rays of a model, indexed by their direction. The key of
+ * a ray is the vector of its components divided by its L1 norm, quantized
+ * to RAY_HASH_STEP, so that parallel rays usually have the same key.
+ */
+struct RayHash
+{
+    int dim;
+    int capacity;
+    long *keys;
+    int *ray_index;
+    long *key;
+};
+
+static int ray_hash_init(struct RayHash *hash, int dim, int max_nrays)
+{
+    int rval = 0;
 
-        rval = LP_get_x(cg->lp, x);
-        abort_if(rval, "LP_get_x failed");
+    hash->dim = dim;
+    hash->capacity = 16;
+    while (hash->capacity < 2 * max_nrays) hash->capacity *= 2;
 
-        rval = copy_solution(cg, x, &cg->current_solution);
-        abort_if(rval, "copy_solution failed");
+    hash->keys = (long *) malloc(hash->capacity * dim * sizeof(long));
+    hash->ray_index = (int *) malloc(hash->capacity * sizeof(int));
+    hash->key = (long *) malloc(dim * sizeof(long));
+    abort_if(!hash->keys, "could not allocate hash->keys");
+    abort_if(!hash->ray_index, "could not allocate hash->ray_index");
+    abort_if(!hash->key, "could not allocate hash->key");
 
-        STATS_increment_added_cuts();
-    }
+    for (int i = 0; i < hash->capacity; i++)
+        hash->ray_index[i] = -1;
 
 CLEANUP:
-    if (x) free(x);
     return rval;
 }
 
-static void dump_row(FILE *file, const struct Row *row, int k)
+static void ray_hash_free(struct RayHash *hash)
 {
-    fprintf(file, "double pi%d[] = { ", k);
-    for(int i = 0; i < row->nz; i++)
-        fprintf(file, "%.10lf, ", row->pi[i]);
-    fprintf(file, "};\n");
-
-    fprintf(file, "int indices%d[] = { ", k);
-    for(int i = 0; i < row->nz; i++)
-        fprintf(file, "%d, ", row->indices[i]);
-    fprintf(file, "};\n");
-
-    fprintf(file, "struct Row row%d = {", k);
-    fprintf(file, ".nz = %d, ", row->nz);
-    fprintf(file, ".head = %d, ", row->head);
-    fprintf(file, ".pi_zero = %.10lf, ", row->pi_zero);
-    fprintf(file, ".pi = pi%d, ", k);
-    fprintf(file, ".indices = indices%d };\n", k);
+    if (hash->keys) free(hash->keys);
+    if (hash->ray_index) free(hash->ray_index);
+    if (hash->key) free(hash->key);
 }
 
-static void dump_cut(const struct Row *cut, long count)
+/*
+ * Computes the key of the given ray, and returns the first slot of its
+ * probe sequence.
+ */
+static int ray_hash_compute_key(struct RayHash *hash,
+                                const double *r,
+                                double norm)
 {
-    char filename[100];
-    sprintf(filename, "cut-%03ld.c", count);
+    unsigned long h = 14695981039346656037UL;
 
-    log_info("Dumping generated cut to file %s\n", filename);
+    for (int i = 0; i < hash->dim; i++)
+    {
+        hash->key[i] = lround(r[i] / norm / RAY_HASH_STEP);
+        h = (h ^ (unsigned long) hash->key[i]) * 1099511628211UL;
+    }
 
-    FILE *file = fopen(filename, "w");
-    dump_row(file, cut, 0);
-    fclose(file);
+    return (int) (h & (unsigned long) (hash->capacity - 1));
 }
 
-static void dump_tableau(const struct Tableau *tableau, long count)
+/*
+ * Looks for a ray parallel to r among the rays in the table. If none is
+ * found, returns in slot the empty slot where r should be inserted. Rays
+ * with zero norm are never matched.
+ */
+static int ray_hash_find(struct RayHash *hash,
+                         const struct RayList *rays,
+                         const double *r,
+                         int *found,
+                         double *scale,
+                         int *index,
+                         int *slot)
 {
-    char filename[100];
-    sprintf(filename, "tableau-%03ld.c", count);
-
-    log_info("Dumping tableau to file %s\n", filename);
-
-    FILE *file = fopen(filename, "w");
+    int rval = 0;
+    int dim = hash->dim;
+    double norm;
+    int k;
 
-    for(int i = 0; i < tableau->nrows; i++)
-        dump_row(file, tableau->rows[i], i);
+    *found = 0;
+    *slot = -1;
 
-    fprintf(file, "struct Row* rows[] = {");
-    for(int i = 0; i < tableau->nrows; i++)
-        fprintf(file, "&row%d, ", i);
-    fprintf(file, "};\n");
+    rval = ray_norm(dim, r, &norm);
+    abort_if(rval, "ray_norm failed");
 
-    fprintf(file, "char column_types[] = {");
-    for(int i = 0; i < tableau->ncols; i++)
-        fprintf(file, "%d, ", tableau->column_types[i]);
-    fprintf(file, "};\n");
+    if (DOUBLE_iszero(norm)) goto CLEANUP;
 
-    fprintf(file, "struct Tableau tableau = {");
-    fprintf(file, ".ncols = %d, ", tableau->ncols);
-    fprintf(file, ".nrows = %d, ", tableau->nrows);
-    fprintf(file, ".rows = rows, ");
-    fprintf(file, ".column_types = column_types };\n");
+    k = ray_hash_compute_key(hash, r, norm);
 
-    fclose(file);
-}
+    for (; hash->ray_index[k] >= 0; k = (k + 1) & (hash->capacity - 1))
+    {
+        if (memcmp(&hash->keys[k * dim], hash->key, dim * sizeof(long)))
+            continue;
 
-static void dump_integral_solution(const struct CG *cg, long count)
-{
-    char filename[100];
-    sprintf(filename, "solution-%03ld.c", count);
+        int match;
+        const double *q = LFREE_get_ray(rays, hash->ray_index[k]);
 
-    log_info("Dumping integral solution to file %s\n", filename);
+        rval = check_rays_parallel(dim, r, q, &match, scale);
+        abort_if(rval, "check_rays_parallel failed");
 
-    FILE *file = fopen(filename, "w");
-    double *x = cg->integral_solution;
+        if (match)
+        {
+            *index = hash->ray_index[k];
+            *found = 1;
+            goto CLEANUP;
+        }
+    }
 
-    fprintf(file, "x[%d] = {", cg->ncols);
-    for(int i = 0; i < cg->ncols; i++)
-        fprintf(file, "%.10lf, ", x[i]);
-    fprintf(file, "};\n");
+    *slot = k;
 
-    fclose(file);
+CLEANUP:
+    return rval;
 }
 
-#ifndef TEST_SOURCE
-
-double CG_replace_x(const struct Row *row, const double *x)
+static void ray_hash_insert(struct RayHash *hash, int slot, int index)
 {
-    double lhs = 0;
-    double *terms = (double*) malloc(row->nz * sizeof(double));
-
-    for (int i = 0; i < row->nz; i++)
-    {
-        double pii = row->pi[i];
-        int idx = row->indices[i];
-        terms[i] = pii * x[idx];
-    }
-
-    DOUBLE_sum(terms, row->nz, &lhs);
-
-    free(terms);
-    return lhs;
+    memcpy(&hash->keys[slot * hash->dim], hash->key,
+            hash->dim * sizeof(long));
+    hash->ray_index[slot] = index;
 }
 
 /*
@@ -472,12 +1320,16 @@ int CG_extract_model(const struct Tableau *tableau,
 
     int *i = 0;
     int *idx = 0;
+    struct RayHash hash = {0};
 
     i = (int *) malloc(nrows * sizeof(int));
     idx = (int *) malloc(nrows * sizeof(int));
     abort_if(!i, "could not allocate i");
     abort_if(!idx, "could not allocate idx");
 
+    rval = ray_hash_init(&hash, nrows, CG_total_nz(tableau));
+    abort_if(rval, "ray_hash_init failed");
+
     for (int j = 0; j < nrows; j++)
         i[j] = 0;
 
@@ -516,20 +1368,22 @@ int CG_extract_model(const struct Tableau *tableau,
         int found;
         double scale;
         int ray_index;
+        int slot;
 
         log_verbose("  extracted ray (%d):\n", idx_min);
         for (int j = 0; j < nrows; j++)
                 log_verbose("    r[%d] = %.12lf\n", j, r[j]);
 
-        rval = CG_find_ray(&model->rays, r, &found, &scale, &ray_index);
-        abort_if(rval, "CG_find_ray failed");
+        rval = ray_hash_find(&hash, &model->rays, r, &found, &scale,
+                &ray_index, &slot);
+        abort_if(rval, "ray_hash_find failed");
 
-        found = 0;
         if (!found)
         {
             log_verbose("  ray is new\n");
             scale = 1.0;
             ray_index = model->rays.nrays++;
+            if (slot >= 0) ray_hash_insert(&hash, slot, ray_index);
         }
         else
         {
@@ -571,6 +1425,7 @@ int CG_extract_model(const struct Tableau *tableau,
 //    }
 
 CLEANUP:
+    ray_hash_free(&hash);
     if (idx) free(idx);
     if (i) free(i);
     return rval;
@@ -583,7 +1438,14 @@ int CG_init(struct LP *lp, char *column_types, struct CG *cg)
     cg->lp = lp;
     cg->column_types = column_types;
 
+    cg->tableau_lp.cplex_env = 0;
+    cg->tableau_lp.cplex_lp = 0;
+    cg->tableau_copies = 0;
+    cg->n_tableau_copies = 0;
     cg->tableau_rows = 0;
+    cg->basis_head = 0;
+    cg->basis_values = 0;
+    cg->lu_tableau = 0;
     cg->cstat = 0;
     cg->rstat = 0;
     cg->ub = 0;
@@ -594,6 +1456,8 @@ int CG_init(struct LP *lp, char *column_types, struct CG *cg)
     cg->basic_solution = 0;
     cg->current_solution = 0;
 
+    cg->pool.cuts = 0;
+
     int nrows = LP_get_num_rows(lp);
     int ncols = LP_get_num_cols(lp);
 
@@ -610,14 +1474,49 @@ int CG_init(struct LP *lp, char *column_types, struct CG *cg)
     abort_if(!cg->ub, "could not allocate cg->ub");
     abort_if(!cg->lb, "could not allocate cg->lb");
 
-    cg->tableau_rows = (struct Row **) malloc(nrows * sizeof(struct Row *));
+    rval = pool_init(&cg->pool, max(max(CUT_POOL_SIZE, CUT_BATCH_SIZE), 1));
+    abort_if(rval, "pool_init failed");
+
+    cg->tableau_rows = (struct Row **) calloc(nrows, sizeof(struct Row *));
+    cg->basis_head = (int *) malloc(nrows * sizeof(int));
+    cg->basis_values = (double *) malloc(nrows * sizeof(double));
+
     abort_if(!cg->tableau_rows, "could not allocate cg->tableau_rows");
+    abort_if(!cg->basis_head, "could not allocate cg->basis_head");
+    abort_if(!cg->basis_values, "could not allocate cg->basis_values");
+
+    /* Tableau rows are only computed when requested, possibly after cuts
+     * have been added to lp, so they are taken either from an LU
+     * factorization of the current basis or from a copy of the problem that
+     * keeps the original basis. */
+    if (TABLEAU_ENGINE == TABLEAU_ENGINE_LU)
+    {
+        rval = LP_get_basis_header(lp, cg->basis_head, cg->basis_values,
+                cg->cstat, cg->rstat, cg->ub, cg->lb);
+        abort_if(rval, "LP_get_basis_header failed");
+
+        cg->lu_tableau = (struct LUTableau *) malloc(sizeof(struct LUTableau));
+        abort_if(!cg->lu_tableau, "could not allocate cg->lu_tableau");
+
+        rval = LU_tableau_init(lp, cg->basis_head, cg->lu_tableau);
+        if (rval)
+        {
+            free(cg->lu_tableau);
+            cg->lu_tableau = 0;
+        }
+        abort_if(rval, "LU_tableau_init failed");
+    }
+    else
+    {
+        rval = LP_clone(lp, &cg->tableau_lp);
+        abort_if(rval, "LP_clone failed");
 
-    rval = LP_get_tableau(lp, cg->tableau_rows, cg->cstat, cg->rstat, cg->ub,
-            cg->lb);
-    abort_if(rval, "LP_get_tableau failed");
+        rval = LP_get_basis_header(&cg->tableau_lp, cg->basis_head,
+                cg->basis_values, cg->cstat, cg->rstat, cg->ub, cg->lb);
+        abort_if(rval, "LP_get_basis_header failed");
+    }
 
-    cg_initial_time = get_user_time();
+    cg_initial_time = get_real_time();
 
 CLEANUP:
     return rval;
@@ -635,32 +1534,63 @@ void CG_free(struct CG *cg)
     if (cg->basic_solution) free(cg->basic_solution);
     if (cg->current_solution) free(cg->current_solution);
 
+    pool_free(&cg->pool);
+
     if (cg->tableau_rows)
     {
         for (int i = 0; i < cg->nrows; i++)
         {
+            if (!cg->tableau_rows[i]) continue;
             LP_free_row(cg->tableau_rows[i]);
             free(cg->tableau_rows[i]);
         }
         free(cg->tableau_rows);
     }
 
+    if (cg->basis_head) free(cg->basis_head);
+    if (cg->basis_values) free(cg->basis_values);
+    if (cg->tableau_copies)
+    {
+        for (int c = 0; c < cg->n_tableau_copies; c++)
+            LP_free(&cg->tableau_copies[c]);
+        free(cg->tableau_copies);
+    }
+
+    LP_destroy(&cg->tableau_lp);
+
+    if (cg->lu_tableau)
+    {
+        LU_tableau_free(cg->lu_tableau);
+        free(cg->lu_tableau);
+    }
+
     free(cg);
 }
 
 int CG_add_single_row_cuts(struct CG *cg, SingleRowGeneratorCallback generate)
 {
     int rval = 0;
+    int *row_selected = 0;
+
+    row_selected = (int *) malloc(cg->nrows * sizeof(int));
+    abort_if(!row_selected, "could not allocate row_selected");
 
     for (int i = 0; i < cg->nrows; i++)
     {
-        struct Row *row = cg->tableau_rows[i];
+        int head = cg->basis_head[i];
 
-        if (frac(row->pi_zero) < EPSILON)
-            continue;
+        row_selected[i] = (frac(cg->basis_values[i]) >= EPSILON && head >= 0
+                && cg->column_types[head] == MILP_INTEGER);
+    }
 
-        if (cg->column_types[row->head] != MILP_INTEGER)
-            continue;
+    rval = prefetch_tableau_rows(cg, row_selected);
+    abort_if(rval, "prefetch_tableau_rows failed");
+
+    for (int i = 0; i < cg->nrows; i++)
+    {
+        if (!row_selected[i]) continue;
+
+        struct Row *row = cg->tableau_rows[i];
 
         log_verbose("Generating cut %d...\n", i);
 
@@ -676,96 +1606,11 @@ int CG_add_single_row_cuts(struct CG *cg, SingleRowGeneratorCallback generate)
         LP_free_row(&cut);
     }
 
-CLEANUP:
-    return rval;
-}
-
-int CG_estimate_multirow_cut_count(struct CG *cg,
-                                   int nrows,
-                                   int *row_selected,
-                                   int *row_affinity,
-                                   long *total_count,
-                                   double score_cutoff)
-{
-    int rval = 0;
-    int *row_indices = 0;
-    int finished = 0;
-
-    *total_count = 0;
-
-    row_indices = (int *) malloc(nrows * sizeof(int));
-    abort_if(!row_indices, "could not allocate row_indices");
-
-    for (int i = 0; i < nrows; i++)
-        row_indices[i] = nrows - i - 1;
-
-    for (int i = 0; i < cg->nrows * cg->nrows; i++)
-        row_affinity[i] = -1;
-
-    do
-    {
-        int inc_index = 0;
-        int is_rhs_integer = 1;
-        int valid_combination = 1;
-
-        for (int i = 0; i < nrows; i++)
-        {
-            struct Row *r = cg->tableau_rows[row_indices[i]];
-
-            if (!row_selected[row_indices[i]])
-            {
-                valid_combination = 0;
-                inc_index = i;
-            }
-
-            double df = fabs(frac(r->pi_zero) - 0.5);
-            if (df < INTEGRALITY_THRESHOLD) is_rhs_integer = 0;
-        }
-
-        if (is_rhs_integer) valid_combination = 0;
-
-        for (int i = 0; valid_combination && i < nrows; i++)
-        {
-            for (int j = i + 1; valid_combination && j < nrows; j++)
-            {
-                int i1 = row_indices[i];
-                int i2 = row_indices[j];
-                if (i2 < i1) swap(i1, i2, int);
-
-                int k = cg->nrows * i1 + i2;
-
-                if (row_affinity[k] < 0)
-                {
-                    struct Row *row1 = cg->tableau_rows[i1];
-                    struct Row *row2 = cg->tableau_rows[i2];
-                    double score;
-
-                    rval = evaluate_row_pair(row1, row2, &score);
-                    abort_if(rval, "evaluate_row_pair failed");
-
-                    row_affinity[k] = 1;
-                    if (score < score_cutoff) row_affinity[k] = 0;
-                }
-
-                if (!row_affinity[k])
-                {
-                    valid_combination = 0;
-                    goto NEXT_COMBINATION;
-                }
-            }
-        }
-
-        if (valid_combination)
-        {
-            (*total_count)++;
-        }
-
-    NEXT_COMBINATION:
-        next_combination(cg->nrows, nrows, row_indices, inc_index, &finished);
-    } while (!finished);
+    rval = flush_cut_pool(cg);
+    abort_if(rval, "flush_cut_pool failed");
 
 CLEANUP:
-    if (row_indices) free(row_indices);
+    if (row_selected) free(row_selected);
     return rval;
 }
 
@@ -787,214 +1632,162 @@ int CG_cut_dynamism(struct Row *cut, double *dynamism)
 
 int CG_add_multirow_cuts(struct CG *cg,
                          int nrows,
-                         MultiRowGeneratorCallback generate)
+                         MultiRowGeneratorCallback generate,
+                         void **contexts)
 {
     int rval = 0;
-    int *row_indices = 0;
-    struct Row **rows = 0;
-    int *row_affinity = 0;
     int *row_selected = 0;
+    int *combinations = 0;
+    int *cut_status = 0;
+    struct Row **rows = 0;
+    struct Row *cuts = 0;
 
-    int finished;
-    long count = 0;
-    long total_count = 0;
+    long n_combinations = 0;
+    int window_size = CG_WINDOW_SIZE * N_THREADS;
+    int timed_out = 0;
 
-    row_indices = (int *) malloc(nrows * sizeof(int));
-    rows = (struct Row **) malloc(nrows * sizeof(struct Row *));
-    row_affinity = (int *) malloc((cg->nrows * cg->nrows) * sizeof(int));
     row_selected = (int *) malloc(cg->nrows * sizeof(int));
+    combinations = (int *) malloc(
+            MAX_SELECTED_COMBINATIONS * nrows * sizeof(int));
+    cut_status = (int *) malloc(window_size * sizeof(int));
+    rows = (struct Row **) malloc(window_size * nrows * sizeof(struct Row *));
+    cuts = (struct Row *) calloc(window_size, sizeof(struct Row));
 
-    abort_if(!row_indices, "could not allocate row_indices");
-    abort_if(!rows, "could not allocate rows");
-    abort_if(!row_affinity, "could not allocate row_affinity");
     abort_if(!row_selected, "could not allocate row_selected");
+    abort_if(!combinations, "could not allocate combinations");
+    abort_if(!cut_status, "could not allocate cut_status");
+    abort_if(!rows, "could not allocate rows");
+    abort_if(!cuts, "could not allocate cuts");
 
     rval = select_rows(cg, row_selected);
     abort_if(rval, "select_rows failed");
 
-    log_info("    Finding combinations...\n");
-    for (double cutoff = 0.05; cutoff <= 1.0; cutoff += 0.05)
-    {
-        double cg_current_time = get_user_time() - cg_initial_time;
-        if (cg_current_time > CG_TIMEOUT) break;
-
-        rval = CG_estimate_multirow_cut_count(cg, nrows, row_selected,
-                row_affinity, &total_count, cutoff);
-        abort_if(rval, "estimate_two_row_cuts_count failed");
-
-        log_verbose("    %8d combinations [%.2lf]\n", total_count, cutoff);
-
-        if (total_count < MAX_SELECTED_COMBINATIONS)
-        {
-            log_info("    %8d combinations [%.2lf]\n", total_count, cutoff);
-            break;
-        }
-    }
-
-    for (int i = 0; i < nrows; i++)
-        row_indices[i] = nrows - i - 1;
+    /* Rows are read concurrently below, so they are all extracted here */
+    rval = prefetch_tableau_rows(cg, row_selected);
+    abort_if(rval, "prefetch_tableau_rows failed");
 
-    total_count = min(total_count, MAX_SELECTED_COMBINATIONS);
+    log_info("    Finding combinations...\n");
+    rval = find_combinations(cg, nrows, row_selected, combinations,
+            &n_combinations);
+    abort_if(rval, "find_combinations failed");
 
-    progress_set_total(total_count);
+    progress_set_total(n_combinations);
     progress_reset();
 
-    do
+    for (long start = 0; start < n_combinations && !timed_out;
+            start += window_size)
     {
-        double cg_current_time = get_user_time() - cg_initial_time;
-        if (cg_current_time > CG_TIMEOUT) break;
+        int window_count = (int) min(window_size, n_combinations - start);
 
-        int inc_index = 0;
-        int is_rhs_integer = 1;
-        int valid_combination = 1;
-
-        for (int i = 0; i < nrows; i++)
+        /* The time limit is checked before each combination. Once a worker
+         * finds that it has been reached, the remaining combinations of the
+         * window are skipped. */
+        #pragma omp parallel for schedule(dynamic) num_threads(N_THREADS)
+        for (int w = 0; w < window_count; w++)
         {
-            rows[i] = cg->tableau_rows[row_indices[i]];
+            int stop;
 
-            if (!row_selected[row_indices[i]])
-            {
-                valid_combination = 0;
-                inc_index = i;
-            }
-
-            double df = fabs(frac(rows[i]->pi_zero) - 0.5);
-            if (df < INTEGRALITY_THRESHOLD) is_rhs_integer = 0;
-        }
+            #pragma omp atomic read
+            stop = timed_out;
 
-        if (is_rhs_integer) valid_combination = 0;
-
-        for (int i = 0; valid_combination && i < nrows; i++)
-        {
-
-            for (int j = i + 1; valid_combination && j < nrows; j++)
+            if (!stop && get_real_time() - cg_initial_time > CG_TIMEOUT)
             {
-                int i1 = row_indices[i];
-                int i2 = row_indices[j];
-                if (i2 < i1) swap(i1, i2, int);
-
-                int k = cg->nrows * i1 + i2;
-
-                abort_if(row_affinity[k] < 0, "row_affinity not computed");
-                if (!row_affinity[k]) valid_combination = 0;
-
-                if_verbose_level
-                {
-                    struct Row *row1 = cg->tableau_rows[i1];
-                    struct Row *row2 = cg->tableau_rows[i2];
-                    double score;
-
-                    rval = evaluate_row_pair(row1, row2, &score);
-                    abort_if(rval, "evaluate_row_pair failed");
-
-                    log_verbose("%4d %4d %.2lf\n", i1, i2, score);
-                }
+                #pragma omp atomic write
+                timed_out = 1;
+                stop = 1;
             }
-        }
 
-        if (valid_combination)
-        {
-            count++;
-            if (count > MAX_SELECTED_COMBINATIONS)
+            if (stop)
             {
-                log_info(
-                        "    maximum number of combinations reached. stopping.\n");
-                break;
+                cut_status[w] = ERR_NO_CUT;
+                continue;
             }
 
-            if_debug_level if (ONLY_CUT > 0 && count != ONLY_CUT)
-                    goto NEXT_COMBINATION;
-
-            if_verbose_level
-            {
-                time_printf("Generating cut %d from [ ", count);
-                for (int i = 0; i < nrows; i++)
-                    printf("%d ", row_indices[i]);
-                printf("]...\n");
-            }
+            cut_status[w] = generate_multirow_cut(cg, nrows,
+                    &combinations[(start + w) * nrows], &rows[w * nrows],
+                    generate, contexts[omp_get_thread_num()], &cuts[w]);
+        }
 
-            if (LOG_LEVEL == LOG_LEVEL_INFO)
-            {
-                progress_print();
-                progress_increment();
-            }
+        for (int w = 0; w < window_count; w++)
+        {
+            struct Row *cut = &cuts[w];
+            long cut_number = start + w + 1;
 
             struct Tableau tableau =
             {
                     .ncols = cg->ncols,
                     .nrows = nrows,
-                    .rows = rows,
+                    .rows = &rows[w * nrows],
                     .column_types = cg->column_types
             };
 
-            if_verbose_level dump_tableau(&tableau, count);
-
-            int max_nz = CG_total_nz(&tableau);
-
-            struct Row cut;
-            rval = LP_init_row(&cut, max_nz);
-            abort_if(rval, "LP_init_row failed");
-
-            double initial_time = get_user_time();
+            if (LOG_LEVEL == LOG_LEVEL_INFO)
+            {
+                progress_print();
+                progress_increment();
+            }
 
-            rval = generate(&tableau, &cut);
-            if (rval == ERR_NO_CUT)
+            if (cut_status[w] == ERR_NO_CUT)
             {
-                rval = 0;
                 log_verbose("combination does not yield cut\n");
-                LP_free_row(&cut);
-                goto NEXT_COMBINATION;
+                goto NEXT_CUT;
             }
-            else if(rval) {
-                dump_tableau(&tableau, count);
-                abort_iff(1, "generate failed (cut %d)", count);
+            else if (cut_status[w])
+            {
+                dump_tableau(&tableau, cut_number);
+                abort_iff(1, "generate failed (cut %ld)", cut_number);
             }
 
-            if_verbose_level dump_cut(&cut, count);
-
-            double elapsed_time = get_user_time() - initial_time;
-            log_verbose("    generate: %.2lf ms\n", elapsed_time * 1000);
+            if_verbose_level
+            {
+                dump_tableau(&tableau, cut_number);
+                dump_cut(cut, cut_number);
+            }
 
             double dynamism;
-            rval = CG_cut_dynamism(&cut, &dynamism);
+            rval = CG_cut_dynamism(cut, &dynamism);
             abort_if(rval, "CG_cut_dynamism failed");
 
             if (dynamism > MAX_CUT_DYNAMISM)
             {
                 log_verbose("Discarding cut (dynamism=%.2lf)\n", dynamism);
-                LP_free_row(&cut);
-                goto NEXT_COMBINATION;
+                goto NEXT_CUT;
             }
 
             int ignored;
-            rval = add_cut(cg, &cut, &ignored);
-            if(rval)
-            {
-                dump_cut(&cut, count);
-                dump_tableau(&tableau, count);
-                dump_integral_solution(cg, count);
-                abort_iff(1, "add_cut failed (cut=%d)", count);
-            }
-
-            if_debug_level if (!ignored)
+            rval = add_cut(cg, cut, &ignored);
+            if (rval)
             {
-                SHOULD_DUMP_CUTS = 1;
-                generate(&tableau, &cut);
-                SHOULD_DUMP_CUTS = 0;
+                dump_cut(cut, cut_number);
+                dump_tableau(&tableau, cut_number);
+                dump_integral_solution(cg, cut_number);
+                abort_iff(1, "add_cut failed (cut=%ld)", cut_number);
             }
 
-            LP_free_row(&cut);
+        NEXT_CUT:
+            LP_free_row(cut);
+            cut->pi = 0;
+            cut->indices = 0;
         }
+    }
+
+    if (timed_out)
+        log_info("    time limit reached. stopping.\n");
 
-    NEXT_COMBINATION:
-        next_combination(cg->nrows, nrows, row_indices, inc_index, &finished);
-    } while (!finished);
+    rval = flush_cut_pool(cg);
+    abort_if(rval, "flush_cut_pool failed");
 
 CLEANUP:
-    if (row_selected) free(row_selected);
-    if (row_affinity) free(row_affinity);
-    if (row_indices) free(row_indices);
+    if (cuts)
+    {
+        for (int w = 0; w < window_size; w++)
+            LP_free_row(&cuts[w]);
+        free(cuts);
+    }
     if (rows) free(rows);
+    if (cut_status) free(cut_status);
+    if (combinations) free(combinations);
+    if (row_selected) free(row_selected);
     return rval;
 }
 
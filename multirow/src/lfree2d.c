@@ -18,6 +18,7 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <multirow/double.h>
 #include <multirow/util.h>
@@ -547,6 +548,8 @@ int LFREE_init_conv(struct ConvLFreeSet *lfree, int dim, int max_nrays)
     int rval = 0;
 
     lfree->nrows = dim;
+    lfree->n_halfspaces = 0;
+    lfree->halfspaces = 0;
     lfree->f = (double*) malloc(dim * sizeof(double));
     lfree->beta = (double*) malloc(max_nrays * sizeof(double));
     abort_if(!lfree->f, "could not allocate lfree->f");
@@ -594,10 +597,807 @@ CLEANUP:
     return rval;
 }
 
+/*
+ * Solves the n-by-n system Ax = b by Gaussian elimination with partial
+ * pivoting. Both A and b are overwritten. Returns non-zero if A is singular.
+ */
+static int solve_dense(int n, double *A, double *b, double *x)
+{
+    double scale = 0;
+    for(int i = 0; i < n * n; i++)
+        scale = fmax(scale, fabs(A[i]));
+
+    if(scale == 0) return 1;
+
+    for(int k = 0; k < n; k++)
+    {
+        int p = k;
+        for(int i = k + 1; i < n; i++)
+            if(fabs(A[i * n + k]) > fabs(A[p * n + k])) p = i;
+
+        if(fabs(A[p * n + k]) < 1e-10 * scale) return 1;
+
+        if(p != k)
+        {
+            for(int j = 0; j < n; j++)
+                swap(A[p * n + j], A[k * n + j], double);
+            swap(b[p], b[k], double);
+        }
+
+        for(int i = k + 1; i < n; i++)
+        {
+            double m = A[i * n + k] / A[k * n + k];
+            if(m == 0) continue;
+            for(int j = k; j < n; j++)
+                A[i * n + j] -= m * A[k * n + j];
+            b[i] -= m * b[k];
+        }
+    }
+
+    for(int k = n - 1; k >= 0; k--)
+    {
+        double v = b[k];
+        for(int j = k + 1; j < n; j++)
+            v -= A[k * n + j] * x[j];
+        x[k] = v / A[k * n + k];
+    }
+
+    return 0;
+}
+
+/*
+ * Advances subset, a sorted k-subset of {0,...,n-1}, to the next subset in
+ * lexicographic order. Returns zero if there is no next subset.
+ */
+static int next_subset(int n, int k, int *subset)
+{
+    int i = k - 1;
+    while(i >= 0 && subset[i] == n - k + i) i--;
+    if(i < 0) return 0;
+
+    subset[i]++;
+    for(int j = i + 1; j < k; j++)
+        subset[j] = subset[j - 1] + 1;
+
+    return 1;
+}
+
+static double binomial(int n, int k)
+{
+    double b = 1;
+    for(int i = 1; i <= k; i++)
+        b = b * (n - k + i) / i;
+    return b;
+}
+
+/*
+ * Returns non-zero if f lies in the interior of the set. This is the case if
+ * and only if the vertices span the space and no hyperplane through f,
+ * spanned by dim - 1 of the vertices, has all the vertices on one side.
+ */
+static int has_interior_origin(int dim,
+                               int nvertices,
+                               const double *vertices,
+                               const double *norms,
+                               double *A,
+                               double *b,
+                               int *subset)
+{
+    int k = dim - 1;
+    int spanning = 0;
+    double g[dim];
+
+    for(int i = 0; i < k; i++)
+        subset[i] = i;
+
+    do
+    {
+        int singular = 1;
+
+        // find g orthogonal to the vertices in the subset, by completing
+        // them with some unit vector into a non-singular system
+        for(int e = 0; e < dim && singular; e++)
+        {
+            for(int i = 0; i < k; i++)
+            {
+                memcpy(&A[i * dim], &vertices[subset[i] * dim],
+                        dim * sizeof(double));
+                b[i] = 0;
+            }
+
+            for(int j = 0; j < dim; j++)
+                A[k * dim + j] = (j == e ? 1.0 : 0.0);
+            b[k] = 1.0;
+
+            singular = solve_dense(dim, A, b, g);
+        }
+
+        if(singular) continue;
+        spanning = 1;
+
+        double g_norm = 0;
+        for(int j = 0; j < dim; j++)
+            g_norm = fmax(g_norm, fabs(g[j]));
+
+        int has_positive = 0, has_negative = 0;
+        for(int i = 0; i < nvertices; i++)
+        {
+            double dot = 0;
+            for(int j = 0; j < dim; j++)
+                dot += g[j] * vertices[i * dim + j];
+
+            double tol = 1e-9 * g_norm * norms[i];
+            if(dot > tol) has_positive = 1;
+            if(dot < -tol) has_negative = 1;
+        }
+
+        if(!has_positive || !has_negative) return 0;
+    }
+    while(next_subset(nvertices, k, subset));
+
+    return spanning;
+}
+
+/*
+ * Appends the halfspace h x <= 1 to the given list, unless the list already
+ * contains it. The list is grown as needed.
+ */
+static int append_halfspace(int dim,
+                            const double *h,
+                            double **halfspaces,
+                            int *n_halfspaces,
+                            int *capacity)
+{
+    int rval = 0;
+
+    for(int k = 0; k < *n_halfspaces; k++)
+    {
+        const double *other = &(*halfspaces)[k * dim];
+
+        int is_duplicate = 1;
+        for(int j = 0; j < dim; j++)
+            if(fabs(other[j] - h[j]) > 1e-6 * (1 + fabs(h[j])))
+                is_duplicate = 0;
+
+        if(is_duplicate) goto CLEANUP;
+    }
+
+    if(*n_halfspaces == *capacity)
+    {
+        double *tmp;
+
+        *capacity = (*capacity == 0 ? 16 : 2 * *capacity);
+        tmp = (double *) realloc(*halfspaces,
+                *capacity * dim * sizeof(double));
+        abort_if(!tmp, "could not allocate halfspaces");
+        *halfspaces = tmp;
+    }
+
+    memcpy(&(*halfspaces)[*n_halfspaces * dim], h, dim * sizeof(double));
+    (*n_halfspaces)++;
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Finds the facets of the convex hull of the vertices by enumerating every
+ * subset of dim vertices and keeping the hyperplanes through them that have
+ * all the vertices on one side. Nothing is produced if the origin does not
+ * lie in the interior of the hull, or if there are more than
+ * MAX_FACET_SUBSETS subsets to enumerate.
+ */
+static int conv_halfspaces_enum(int dim,
+                                int nvertices,
+                                const double *vertices,
+                                const double *norms,
+                                double **halfspaces,
+                                int *n_halfspaces,
+                                int *capacity)
+{
+    int rval = 0;
+
+    int *subset = 0;
+    double *A = 0;
+    double *b = 0;
+    double *h = 0;
+
+    if(binomial(nvertices, dim) + binomial(nvertices, dim - 1)
+            > MAX_FACET_SUBSETS)
+        goto CLEANUP;
+
+    subset = (int *) malloc(dim * sizeof(int));
+    A = (double *) malloc(dim * dim * sizeof(double));
+    b = (double *) malloc(dim * sizeof(double));
+    h = (double *) malloc(dim * sizeof(double));
+    abort_if(!subset, "could not allocate subset");
+    abort_if(!A, "could not allocate A");
+    abort_if(!b, "could not allocate b");
+    abort_if(!h, "could not allocate h");
+
+    if(!has_interior_origin(dim, nvertices, vertices, norms, A, b, subset))
+        goto CLEANUP;
+
+    for(int i = 0; i < dim; i++)
+        subset[i] = i;
+
+    do
+    {
+        // find the hyperplane h x = 1 through the vertices in the subset
+        for(int i = 0; i < dim; i++)
+        {
+            memcpy(&A[i * dim], &vertices[subset[i] * dim],
+                    dim * sizeof(double));
+            b[i] = 1.0;
+        }
+
+        if(solve_dense(dim, A, b, h)) continue;
+
+        int is_valid = 1;
+        for(int i = 0; i < nvertices && is_valid; i++)
+        {
+            double dot = 0;
+            for(int j = 0; j < dim; j++)
+                dot += h[j] * vertices[i * dim + j];
+
+            if(dot > 1 + 1e-6) is_valid = 0;
+        }
+
+        if(!is_valid) continue;
+
+        rval = append_halfspace(dim, h, halfspaces, n_halfspaces, capacity);
+        abort_if(rval, "append_halfspace failed");
+    }
+    while(next_subset(nvertices, dim, subset));
+
+CLEANUP:
+    if(subset) free(subset);
+    if(A) free(A);
+    if(b) free(b);
+    if(h) free(h);
+    return rval;
+}
+
+static int _qsort_cmp_point_2d(const void *p1, const void *p2)
+{
+    const double *a = (const double *) p1;
+    const double *b = (const double *) p2;
+
+    if(a[0] < b[0]) return -1;
+    if(a[0] > b[0]) return 1;
+    if(a[1] < b[1]) return -1;
+    if(a[1] > b[1]) return 1;
+    return 0;
+}
+
+static double cross_2d(const double *o, const double *a, const double *b)
+{
+    return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+}
+
+/*
+ * Finds the edges of the convex hull of the given points in the plane by
+ * Andrew's monotone chain algorithm, in O(n log n) time. Collinear points
+ * are dropped from the hull. If the origin does not lie in the interior of
+ * the hull, no halfspaces are produced.
+ */
+static int conv_halfspaces_2d(int nvertices,
+                              const double *vertices,
+                              double scale,
+                              double **halfspaces,
+                              int *n_halfspaces,
+                              int *capacity)
+{
+    int rval = 0;
+    int m = 0;
+
+    double *points = 0;
+    const double **hull = 0;
+
+    double area_eps = 1e-12 * scale * scale;
+    double dist_eps = 1e-9 * scale;
+
+    points = (double *) malloc(2 * nvertices * sizeof(double));
+    hull = (const double **) malloc((2 * nvertices + 1) * sizeof(double *));
+    abort_if(!points, "could not allocate points");
+    abort_if(!hull, "could not allocate hull");
+
+    memcpy(points, vertices, 2 * nvertices * sizeof(double));
+    qsort(points, (size_t) nvertices, 2 * sizeof(double), _qsort_cmp_point_2d);
+
+    // lower hull, from left to right
+    for(int i = 0; i < nvertices; i++)
+    {
+        const double *p = &points[2 * i];
+        while(m >= 2 && cross_2d(hull[m - 2], hull[m - 1], p) <= area_eps)
+            m--;
+        hull[m++] = p;
+    }
+
+    // upper hull, from right to left
+    for(int i = nvertices - 2, lower = m + 1; i >= 0; i--)
+    {
+        const double *p = &points[2 * i];
+        while(m >= lower && cross_2d(hull[m - 2], hull[m - 1], p) <= area_eps)
+            m--;
+        hull[m++] = p;
+    }
+
+    // the first point was added again at the end
+    m--;
+    if(m < 3) goto CLEANUP;
+
+    for(int k = 0; k < m; k++)
+    {
+        const double *p = hull[k];
+        const double *q = hull[(k + 1) % m];
+
+        // outward normal of the edge, since the hull is counter-clockwise
+        double n[] = { q[1] - p[1], p[0] - q[0] };
+        double c = n[0] * p[0] + n[1] * p[1];
+
+        if(c <= dist_eps * fmax(fabs(n[0]), fabs(n[1])))
+        {
+            *n_halfspaces = 0;
+            goto CLEANUP;
+        }
+
+        double h[] = { n[0] / c, n[1] / c };
+
+        rval = append_halfspace(2, h, halfspaces, n_halfspaces, capacity);
+        abort_if(rval, "append_halfspace failed");
+    }
+
+CLEANUP:
+    if(points) free(points);
+    if(hull) free(hull);
+    return rval;
+}
+
+struct HullFace3D
+{
+    int v[3];
+    double n[3];
+    double c;
+    int alive;
+};
+
+static double dot_3d(const double *a, const double *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/*
+ * Computes the unit normal n and the offset c of the plane n x = c through
+ * the vertices of the face, oriented by the right-hand rule. Returns non-zero
+ * if the vertices are collinear.
+ */
+static int hull_face_plane(struct HullFace3D *face,
+                           const double *vertices,
+                           double area_eps)
+{
+    const double *a = &vertices[3 * face->v[0]];
+    const double *b = &vertices[3 * face->v[1]];
+    const double *p = &vertices[3 * face->v[2]];
+
+    double u[] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    double w[] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+
+    face->n[0] = u[1] * w[2] - u[2] * w[1];
+    face->n[1] = u[2] * w[0] - u[0] * w[2];
+    face->n[2] = u[0] * w[1] - u[1] * w[0];
+
+    double norm = sqrt(dot_3d(face->n, face->n));
+    if(norm <= area_eps) return 1;
+
+    for(int j = 0; j < 3; j++)
+        face->n[j] /= norm;
+
+    face->c = dot_3d(face->n, a);
+    face->alive = 1;
+    return 0;
+}
+
+static int hull_push_face(struct HullFace3D **faces,
+                          int *n_faces,
+                          int *capacity,
+                          int a,
+                          int b,
+                          int p,
+                          const double *vertices,
+                          double area_eps)
+{
+    int rval = 0;
+
+    if(*n_faces == *capacity)
+    {
+        struct HullFace3D *tmp;
+
+        *capacity = 2 * *capacity;
+        tmp = (struct HullFace3D *) realloc(*faces,
+                *capacity * sizeof(struct HullFace3D));
+        abort_if(!tmp, "could not allocate faces");
+        *faces = tmp;
+    }
+
+    struct HullFace3D *face = &(*faces)[*n_faces];
+    face->v[0] = a;
+    face->v[1] = b;
+    face->v[2] = p;
+
+    // collinear faces only appear under round-off and are left out
+    if(hull_face_plane(face, vertices, area_eps)) goto CLEANUP;
+    (*n_faces)++;
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Finds the facets of the convex hull of the given points in space by the
+ * quickhull algorithm: starting from a tetrahedron, the point farthest above
+ * some face is repeatedly added to the hull, replacing the faces it sees by a
+ * cone over their horizon. Points that lie below every face are interior and
+ * never visited again. If the origin does not lie in the interior of the
+ * hull, no halfspaces are produced.
+ */
+static int conv_halfspaces_3d(int nvertices,
+                              const double *vertices,
+                              double scale,
+                              double **halfspaces,
+                              int *n_halfspaces,
+                              int *capacity)
+{
+    int rval = 0;
+    int n_faces = 0;
+    int face_capacity = 32;
+    int n_horizon = 0;
+    int horizon_capacity = 0;
+
+    struct HullFace3D *faces = 0;
+    int *horizon = 0;
+    char *done = 0;
+
+    double area_eps = 1e-12 * scale * scale;
+    double dist_eps = 1e-9 * scale;
+
+    int init[4] = { 0, 0, 0, 0 };
+    struct HullFace3D base;
+    double best;
+
+    faces = (struct HullFace3D *) malloc(face_capacity *
+            sizeof(struct HullFace3D));
+    done = (char *) calloc(nvertices, sizeof(char));
+    abort_if(!faces, "could not allocate faces");
+    abort_if(!done, "could not allocate done");
+
+    // initial tetrahedron: an extreme point, the point farthest from it, the
+    // point farthest from the line through both and the point farthest from
+    // the plane through the three
+    for(int i = 1; i < nvertices; i++)
+        if(vertices[3 * i] < vertices[3 * init[0]]) init[0] = i;
+
+    best = 0;
+    for(int i = 0; i < nvertices; i++)
+    {
+        double d[3];
+        for(int j = 0; j < 3; j++)
+            d[j] = vertices[3 * i + j] - vertices[3 * init[0] + j];
+
+        if(dot_3d(d, d) > best)
+        {
+            best = dot_3d(d, d);
+            init[1] = i;
+        }
+    }
+
+    best = area_eps;
+    for(int i = 0; i < nvertices; i++)
+    {
+        double u[3], w[3];
+        for(int j = 0; j < 3; j++)
+        {
+            u[j] = vertices[3 * init[1] + j] - vertices[3 * init[0] + j];
+            w[j] = vertices[3 * i + j] - vertices[3 * init[0] + j];
+        }
+
+        double area = sqrt(dot_3d(u, u) * dot_3d(w, w)
+                - dot_3d(u, w) * dot_3d(u, w));
+
+        if(area > best)
+        {
+            best = area;
+            init[2] = i;
+        }
+    }
+
+    if(best <= area_eps) goto CLEANUP;
+
+    base.v[0] = init[0];
+    base.v[1] = init[1];
+    base.v[2] = init[2];
+    abort_if(hull_face_plane(&base, vertices, area_eps), "collinear base");
+
+    best = dist_eps;
+    for(int i = 0; i < nvertices; i++)
+    {
+        double dist = fabs(dot_3d(base.n, &vertices[3 * i]) - base.c);
+        if(dist > best)
+        {
+            best = dist;
+            init[3] = i;
+        }
+    }
+
+    // all the points are coplanar, so the origin cannot be interior
+    if(best <= dist_eps) goto CLEANUP;
+
+    if(dot_3d(base.n, &vertices[3 * init[3]]) > base.c)
+        swap(init[1], init[2], int);
+
+    for(int k = 0; k < 4; k++)
+        done[init[k]] = 1;
+
+    rval = hull_push_face(&faces, &n_faces, &face_capacity,
+            init[0], init[1], init[2], vertices, area_eps);
+    abort_if(rval, "hull_push_face failed");
+
+    rval = hull_push_face(&faces, &n_faces, &face_capacity,
+            init[0], init[3], init[1], vertices, area_eps);
+    abort_if(rval, "hull_push_face failed");
+
+    rval = hull_push_face(&faces, &n_faces, &face_capacity,
+            init[1], init[3], init[2], vertices, area_eps);
+    abort_if(rval, "hull_push_face failed");
+
+    rval = hull_push_face(&faces, &n_faces, &face_capacity,
+            init[2], init[3], init[0], vertices, area_eps);
+    abort_if(rval, "hull_push_face failed");
+
+    while(1)
+    {
+        int p = -1;
+        best = dist_eps;
+
+        for(int i = 0; i < nvertices; i++)
+        {
+            if(done[i]) continue;
+
+            int outside = 0;
+            for(int f = 0; f < n_faces; f++)
+            {
+                if(!faces[f].alive) continue;
+
+                double dist = dot_3d(faces[f].n, &vertices[3 * i])
+                        - faces[f].c;
+
+                if(dist > dist_eps) outside = 1;
+                if(dist > best)
+                {
+                    best = dist;
+                    p = i;
+                }
+            }
+
+            if(!outside) done[i] = 1;
+        }
+
+        if(p < 0) break;
+        done[p] = 1;
+
+        // The horizon is made of the edges of visible faces whose opposite
+        // face is not visible. Faces are oriented consistently, so the
+        // opposite face of edge (a,b) is the face containing edge (b,a).
+        n_horizon = 0;
+        for(int f = 0; f < n_faces; f++)
+        {
+            if(!faces[f].alive) continue;
+            if(dot_3d(faces[f].n, &vertices[3 * p]) - faces[f].c <= dist_eps)
+                continue;
+
+            for(int e = 0; e < 3; e++)
+            {
+                int a = faces[f].v[e];
+                int b = faces[f].v[(e + 1) % 3];
+                int is_horizon = 1;
+
+                for(int g = 0; g < n_faces; g++)
+                {
+                    if(!faces[g].alive || g == f) continue;
+
+                    int has_edge = 0;
+                    for(int e2 = 0; e2 < 3; e2++)
+                        if(faces[g].v[e2] == b && faces[g].v[(e2 + 1) % 3] == a)
+                            has_edge = 1;
+
+                    if(!has_edge) continue;
+
+                    double dist = dot_3d(faces[g].n, &vertices[3 * p])
+                            - faces[g].c;
+                    is_horizon = (dist <= dist_eps);
+                    break;
+                }
+
+                if(!is_horizon) continue;
+
+                if(2 * n_horizon + 2 > horizon_capacity)
+                {
+                    int *tmp;
+
+                    horizon_capacity = max(64, 2 * horizon_capacity);
+                    tmp = (int *) realloc(horizon,
+                            horizon_capacity * sizeof(int));
+                    abort_if(!tmp, "could not allocate horizon");
+                    horizon = tmp;
+                }
+
+                horizon[2 * n_horizon] = a;
+                horizon[2 * n_horizon + 1] = b;
+                n_horizon++;
+            }
+        }
+
+        for(int f = 0; f < n_faces; f++)
+            if(faces[f].alive &&
+                    dot_3d(faces[f].n, &vertices[3 * p]) - faces[f].c
+                    > dist_eps)
+                faces[f].alive = 0;
+
+        for(int k = 0; k < n_horizon; k++)
+        {
+            rval = hull_push_face(&faces, &n_faces, &face_capacity,
+                    horizon[2 * k], horizon[2 * k + 1], p, vertices,
+                    area_eps);
+            abort_if(rval, "hull_push_face failed");
+        }
+    }
+
+    for(int f = 0; f < n_faces; f++)
+    {
+        if(!faces[f].alive) continue;
+
+        if(faces[f].c <= dist_eps)
+        {
+            *n_halfspaces = 0;
+            goto CLEANUP;
+        }
+
+        double h[3];
+        for(int j = 0; j < 3; j++)
+            h[j] = faces[f].n[j] / faces[f].c;
+
+        rval = append_halfspace(3, h, halfspaces, n_halfspaces, capacity);
+        abort_if(rval, "append_halfspace failed");
+    }
+
+CLEANUP:
+    if(faces) free(faces);
+    if(horizon) free(horizon);
+    if(done) free(done);
+    return rval;
+}
+
+/*
+ * Returns non-zero if every vertex satisfies every halfspace h x <= 1.
+ */
+static int halfspaces_are_valid(int dim,
+                                int nvertices,
+                                const double *vertices,
+                                int n_halfspaces,
+                                const double *halfspaces)
+{
+    for(int k = 0; k < n_halfspaces; k++)
+    {
+        const double *h = &halfspaces[k * dim];
+
+        for(int i = 0; i < nvertices; i++)
+        {
+            double dot = 0;
+            for(int j = 0; j < dim; j++)
+                dot += h[j] * vertices[i * dim + j];
+
+            if(dot > 1 + 1e-6) return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Computes the facets of the given set, that is, the convex hull of the
+ * points f + beta_i r_i. Each facet is stored as a vector h such that the
+ * set is described by h (x - f) <= 1.
+ *
+ * In two and three dimensions, facets are found by the monotone chain and
+ * quickhull algorithms. In higher dimensions, or if round-off leaves some
+ * vertex outside the hull, they are found by enumerating every subset of dim
+ * vertices, which is only done when the number of such subsets does not
+ * exceed MAX_FACET_SUBSETS. If the computation is not performed, or if f does
+ * not lie in the interior of the set, n_halfspaces is set to zero.
+ *
+ * @param lfree the lattice-free set
+ * @return zero if successful, non-zero otherwise
+ */
+int LFREE_compute_conv_halfspaces(struct ConvLFreeSet *lfree)
+{
+    int rval = 0;
+
+    int dim = lfree->nrows;
+    int nvertices = lfree->rays.nrays;
+    int capacity = 0;
+    double scale = 0;
+
+    double *norms = 0;
+    double *vertices = 0;
+    double *halfspaces = 0;
+
+    free(lfree->halfspaces);
+    lfree->halfspaces = 0;
+    lfree->n_halfspaces = 0;
+
+    if(nvertices < dim + 1) goto CLEANUP;
+
+    norms = (double *) malloc(nvertices * sizeof(double));
+    vertices = (double *) malloc(nvertices * dim * sizeof(double));
+    abort_if(!norms, "could not allocate norms");
+    abort_if(!vertices, "could not allocate vertices");
+
+    for(int i = 0; i < nvertices; i++)
+    {
+        const double *r = LFREE_get_ray(&lfree->rays, i);
+
+        norms[i] = 0;
+        for(int j = 0; j < dim; j++)
+        {
+            vertices[i * dim + j] = r[j] * lfree->beta[i];
+            norms[i] = fmax(norms[i], fabs(vertices[i * dim + j]));
+        }
+
+        if(!isfinite(norms[i])) goto CLEANUP;
+        scale = fmax(scale, norms[i]);
+    }
+
+    if(scale == 0) goto CLEANUP;
+
+    if(dim == 2)
+    {
+        rval = conv_halfspaces_2d(nvertices, vertices, scale, &halfspaces,
+                &lfree->n_halfspaces, &capacity);
+        abort_if(rval, "conv_halfspaces_2d failed");
+    }
+    else if(dim == 3)
+    {
+        rval = conv_halfspaces_3d(nvertices, vertices, scale, &halfspaces,
+                &lfree->n_halfspaces, &capacity);
+        abort_if(rval, "conv_halfspaces_3d failed");
+    }
+
+    if(dim > 3 || !halfspaces_are_valid(dim, nvertices, vertices,
+            lfree->n_halfspaces, halfspaces))
+    {
+        lfree->n_halfspaces = 0;
+
+        rval = conv_halfspaces_enum(dim, nvertices, vertices, norms,
+                &halfspaces, &lfree->n_halfspaces, &capacity);
+        abort_if(rval, "conv_halfspaces_enum failed");
+    }
+
+    lfree->halfspaces = halfspaces;
+    halfspaces = 0;
+
+CLEANUP:
+    if(rval) lfree->n_halfspaces = 0;
+    if(norms) free(norms);
+    if(vertices) free(vertices);
+    if(halfspaces) free(halfspaces);
+    return rval;
+}
+
 void LFREE_free_conv(struct ConvLFreeSet *lfree)
 {
     if(!lfree) return;
     free(lfree->f);
     free(lfree->beta);
+    free(lfree->halfspaces);
     LFREE_free_ray_list(&lfree->rays);
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
  */
 
 #include <math.h>
+#include <stdlib.h>
 #include <cblas.h>
 #include <lapacke.h>
 #include <multirow/util.h>
@@ -49,4 +50,67 @@ int LINALG_solve(int n, int m, double *A, double *b, double *x)
 
 CLEANUP:
     return rval;
-}
\ No newline at end of file
+}
+
+/*
+ * Number of rows of R multiplied at a time, to bound the size of the
+ * intermediate product.
+ */
+#define MAX_PRODUCT_BLOCK 256
+
+int LINALG_max_product(int m,
+                       int n,
+                       int k,
+                       const double *H,
+                       const double *R,
+                       double *y)
+{
+    int rval = 0;
+    double *P = 0;
+
+    if(k <= 3)
+    {
+        // for very few columns, a direct loop is faster than dgemm
+        for(int i = 0; i < n; i++)
+        {
+            const double *r = &R[i * k];
+            double best = -INFINITY;
+
+            for(int j = 0; j < m; j++)
+            {
+                const double *h = &H[j * k];
+                double v = h[0] * r[0];
+                if(k > 1) v += h[1] * r[1];
+                if(k > 2) v += h[2] * r[2];
+                best = fmax(best, v);
+            }
+
+            y[i] = best;
+        }
+
+        goto CLEANUP;
+    }
+
+    P = (double *) malloc(MAX_PRODUCT_BLOCK * m * sizeof(double));
+    abort_if(!P, "could not allocate P");
+
+    for(int start = 0; start < n; start += MAX_PRODUCT_BLOCK)
+    {
+        int block = min(MAX_PRODUCT_BLOCK, n - start);
+
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, block, m, k, 1.0,
+                &R[start * k], k, H, k, 0.0, P, m);
+
+        for(int i = 0; i < block; i++)
+        {
+            double best = -INFINITY;
+            for(int j = 0; j < m; j++)
+                best = fmax(best, P[i * m + j]);
+            y[start + i] = best;
+        }
+    }
+
+CLEANUP:
+    if(P) free(P);
+    return rval;
+}
@@ -78,6 +78,154 @@ void LP_free(struct LP *lp)
     lp->cplex_env = 0;
 }
 
+int LP_is_open(struct LP *lp)
+{
+    return (lp->cplex_env != 0);
+}
+
+void LP_destroy(struct LP *lp)
+{
+    if (!lp) return;
+    if (!lp->cplex_env) return;
+
+    if (lp->cplex_lp)
+        CPXfreeprob(lp->cplex_env, &(lp->cplex_lp));
+
+    lp->cplex_lp = 0;
+}
+
+/*
+ * Pool of CPLEX environments used for auxiliary problems. Each thread keeps
+ * its own environment, which is opened on first use and reused afterwards.
+ * All environments ever opened are also recorded, so that LP_pool_free can
+ * close them. Environments cached by threads are invalidated by increasing
+ * the pool generation. LP_pool_free must not be called while other threads
+ * are using the pool.
+ */
+static CPXENVptr lp_pool_env = 0;
+static long lp_pool_env_generation = -1;
+#pragma omp threadprivate(lp_pool_env, lp_pool_env_generation)
+
+static long lp_pool_generation = 0;
+static CPXENVptr *lp_pool_envs = 0;
+static int lp_pool_nenvs = 0;
+static int lp_pool_capacity = 0;
+
+static int pool_register_env(CPXENVptr env)
+{
+    int rval = 0;
+
+    if (lp_pool_nenvs >= lp_pool_capacity)
+    {
+        int capacity = max(8, 2 * lp_pool_capacity);
+
+        lp_pool_envs = (CPXENVptr *) realloc(lp_pool_envs,
+                capacity * sizeof(CPXENVptr));
+        abort_if(!lp_pool_envs, "could not allocate lp_pool_envs");
+
+        lp_pool_capacity = capacity;
+    }
+
+    lp_pool_envs[lp_pool_nenvs++] = env;
+
+CLEANUP:
+    return rval;
+}
+
+int LP_pool_acquire(struct LP *lp)
+{
+    int rval = 0;
+
+    lp->cplex_env = 0;
+    lp->cplex_lp = 0;
+
+    if (!lp_pool_env || lp_pool_env_generation != lp_pool_generation)
+    {
+        struct LP env;
+
+        rval = LP_open(&env);
+        abort_if(rval, "LP_open failed");
+
+        #pragma omp critical(lp_pool)
+        {
+            rval = pool_register_env(env.cplex_env);
+            lp_pool_env_generation = lp_pool_generation;
+        }
+
+        if (rval) LP_free(&env);
+        abort_if(rval, "pool_register_env failed");
+
+        lp_pool_env = env.cplex_env;
+    }
+
+    lp->cplex_env = lp_pool_env;
+
+CLEANUP:
+    return rval;
+}
+
+void LP_pool_release(struct LP *lp)
+{
+    LP_destroy(lp);
+    lp->cplex_env = 0;
+}
+
+void LP_pool_free()
+{
+    #pragma omp critical(lp_pool)
+    {
+        for (int i = 0; i < lp_pool_nenvs; i++)
+            CPXcloseCPLEX(&lp_pool_envs[i]);
+
+        if (lp_pool_envs) free(lp_pool_envs);
+
+        lp_pool_envs = 0;
+        lp_pool_nenvs = 0;
+        lp_pool_capacity = 0;
+        lp_pool_generation++;
+    }
+
+    lp_pool_env = 0;
+}
+
+int LP_clone(struct LP *lp, struct LP *clone)
+{
+    int rval = 0;
+    int infeasible;
+
+    int *cstat = 0;
+    int *rstat = 0;
+
+    int nrows = LP_get_num_rows(lp);
+    int ncols = LP_get_num_cols(lp);
+
+    clone->cplex_env = lp->cplex_env;
+    clone->cplex_lp = 0;
+
+    cstat = (int *) malloc(ncols * sizeof(int));
+    rstat = (int *) malloc(nrows * sizeof(int));
+    abort_if(!cstat, "could not allocate cstat");
+    abort_if(!rstat, "could not allocate rstat");
+
+    rval = CPXgetbase(lp->cplex_env, lp->cplex_lp, cstat, rstat);
+    abort_if(rval, "CPXgetbase failed");
+
+    clone->cplex_lp = CPXcloneprob(lp->cplex_env, lp->cplex_lp, &rval);
+    abort_if(rval, "CPXcloneprob failed");
+
+    rval = CPXcopybase(clone->cplex_env, clone->cplex_lp, cstat, rstat);
+    abort_if(rval, "CPXcopybase failed");
+
+    rval = LP_optimize(clone, &infeasible);
+    abort_if(rval, "LP_optimize failed");
+    abort_if(infeasible, "clone is infeasible");
+
+CLEANUP:
+    if (rstat) free(rstat);
+    if (cstat) free(cstat);
+    return rval;
+}
+
 void LP_free_row(struct Row *row)
 {
     if (!row) return;
@@ -389,29 +537,22 @@ CLEANUP:
     return rval;
 }
 
-int LP_get_tableau(struct LP *lp,
-                   struct Row **rows,
-                   int *cstat,
-                   int *rstat,
-                   double *ub,
-                   double *lb)
+int LP_get_basis_header(struct LP *lp,
+                        int *head,
+                        double *rhs,
+                        int *cstat,
+                        int *rstat,
+                        double *ub,
+                        double *lb)
 {
     int rval = 0;
 
     int nrows = LP_get_num_rows(lp);
     int ncols = LP_get_num_cols(lp);
 
-    int *head = 0;
-    double *rhs = 0;
-    double *pi = 0;
     double *slacks = 0;
 
-    rhs = (double *) malloc(nrows * sizeof(double));
-    head = (int *) malloc(nrows * sizeof(int));
     slacks = (double*) malloc(nrows * sizeof(double));
-
-    abort_if(!head, "could not allocate head");
-    abort_if(!rhs, "could not allocate rhs");
     abort_if(!slacks, "could not allocate slacks");
 
     rval = CPXgetbhead(lp->cplex_env, lp->cplex_lp, head, rhs);
@@ -432,66 +573,465 @@ int LP_get_tableau(struct LP *lp,
     for (int i = 0; i < nrows; i++)
         abort_if(!DOUBLE_iszero(slacks[i]), "model contains slack variables");
 
+CLEANUP:
+    if(slacks) free(slacks);
+    return rval;
+}
+
+int LP_tableau_row_from_dense(int ncols,
+                              const double *pi,
+                              int head,
+                              double rhs,
+                              int *cstat,
+                              double *ub,
+                              double *lb,
+                              struct Row *row)
+{
+    int rval = 0;
+    int nz = 0;
+    int k = 0;
+
+    row->pi = 0;
+    row->indices = 0;
+
+    for (int j = 0; j < ncols; j++)
+    {
+        if (fabs(pi[j]) < EPSILON)
+            continue;
+
+        if (cstat[j] == CPX_AT_LOWER)
+            rhs += lb[j] * pi[j];
+
+        if (cstat[j] == CPX_AT_UPPER)
+            rhs += ub[j] * pi[j];
+
+        nz++;
+    }
+
+    row->nz = nz;
+    row->pi_zero = rhs;
+    row->head = head;
+
+    row->pi = (double *) malloc(nz * sizeof(double));
+    row->indices = (int *) malloc(nz * sizeof(int));
+
+    abort_if(!row->pi, "could not allocate row->pi");
+    abort_if(!row->indices, "could not allocate row->indices");
+
+    if (fabs(row->pi_zero) < EPSILON)
+        row->pi_zero = 0;
+
+    for (int j = 0; j < ncols; j++)
+    {
+        if (fabs(pi[j]) < EPSILON)
+            continue;
+
+        row->pi[k] = pi[j];
+        row->indices[k++] = j;
+    }
+
+    rval = LP_flip_row_coefficients(cstat, lb, ub, row);
+    abort_if(rval, "LP_flip_row_coefficients failed");
+
+CLEANUP:
+    return rval;
+}
+
+int LP_get_tableau_row(struct LP *lp,
+                       int index,
+                       int head,
+                       double rhs,
+                       int *cstat,
+                       double *ub,
+                       double *lb,
+                       double *pi,
+                       struct Row *row)
+{
+    int rval = 0;
+
+    row->pi = 0;
+    row->indices = 0;
+
+    rval = CPXbinvarow(lp->cplex_env, lp->cplex_lp, index, pi);
+    abort_if(rval, "CPXbinvarow failed");
+
+    rval = LP_tableau_row_from_dense(LP_get_num_cols(lp), pi, head, rhs, cstat,
+            ub, lb, row);
+    abort_if(rval, "LP_tableau_row_from_dense failed");
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Data needed to load a copy of a problem into a different environment.
+ * Bounds and basis status are not owned by this structure.
+ */
+struct ProblemData
+{
+    int nrows;
+    int ncols;
+    int objsen;
+
+    double *obj;
+    double *rhs;
+    double *rngval;
+    char *sense;
+
+    int *matbeg;
+    int *matcnt;
+    int *matind;
+    double *matval;
+
+    double *ub;
+    double *lb;
+    int *cstat;
+    int *rstat;
+};
+
+static void free_problem_data(struct ProblemData *data)
+{
+    if (data->obj) free(data->obj);
+    if (data->rhs) free(data->rhs);
+    if (data->rngval) free(data->rngval);
+    if (data->sense) free(data->sense);
+    if (data->matbeg) free(data->matbeg);
+    if (data->matcnt) free(data->matcnt);
+    if (data->matind) free(data->matind);
+    if (data->matval) free(data->matval);
+}
+
+static int read_problem_data(struct LP *lp,
+                             int *cstat,
+                             int *rstat,
+                             double *ub,
+                             double *lb,
+                             struct ProblemData *data)
+{
+    int rval = 0;
+    int nz = 0, surplus = 0;
+
+    int nrows = LP_get_num_rows(lp);
+    int ncols = LP_get_num_cols(lp);
+
+    data->nrows = nrows;
+    data->ncols = ncols;
+    data->ub = ub;
+    data->lb = lb;
+    data->cstat = cstat;
+    data->rstat = rstat;
+
+    data->obj = (double *) malloc(ncols * sizeof(double));
+    data->rhs = (double *) malloc(nrows * sizeof(double));
+    data->rngval = (double *) malloc(nrows * sizeof(double));
+    data->sense = (char *) malloc(nrows * sizeof(char));
+    data->matbeg = (int *) malloc(ncols * sizeof(int));
+    data->matcnt = (int *) malloc(ncols * sizeof(int));
+    data->matind = 0;
+    data->matval = 0;
+
+    abort_if(!data->obj, "could not allocate obj");
+    abort_if(!data->rhs, "could not allocate rhs");
+    abort_if(!data->rngval, "could not allocate rngval");
+    abort_if(!data->sense, "could not allocate sense");
+    abort_if(!data->matbeg, "could not allocate matbeg");
+    abort_if(!data->matcnt, "could not allocate matcnt");
+
+    data->objsen = CPXgetobjsen(lp->cplex_env, lp->cplex_lp);
+
+    rval = CPXgetobj(lp->cplex_env, lp->cplex_lp, data->obj, 0, ncols - 1);
+    abort_if(rval, "CPXgetobj failed");
+
+    rval = CPXgetrhs(lp->cplex_env, lp->cplex_lp, data->rhs, 0, nrows - 1);
+    abort_if(rval, "CPXgetrhs failed");
+
+    rval = CPXgetsense(lp->cplex_env, lp->cplex_lp, data->sense, 0,
+            nrows - 1);
+    abort_if(rval, "CPXgetsense failed");
+
+    rval = CPXgetrngval(lp->cplex_env, lp->cplex_lp, data->rngval, 0,
+            nrows - 1);
+    abort_if(rval, "CPXgetrngval failed");
+
+    rval = CPXgetcols(lp->cplex_env, lp->cplex_lp, &nz, data->matbeg, 0, 0, 0,
+            &surplus, 0, ncols - 1);
+    abort_if(rval && rval != CPXERR_NEGATIVE_SURPLUS, "CPXgetcols failed");
+
+    int space = -surplus;
+    data->matind = (int *) malloc(max(space, 1) * sizeof(int));
+    data->matval = (double *) malloc(max(space, 1) * sizeof(double));
+    abort_if(!data->matind, "could not allocate matind");
+    abort_if(!data->matval, "could not allocate matval");
+
+    rval = CPXgetcols(lp->cplex_env, lp->cplex_lp, &nz, data->matbeg,
+            data->matind, data->matval, space, &surplus, 0, ncols - 1);
+    abort_if(rval, "CPXgetcols failed");
+
+    for (int j = 0; j < ncols; j++)
+    {
+        int end = (j + 1 < ncols ? data->matbeg[j + 1] : nz);
+        data->matcnt[j] = end - data->matbeg[j];
+    }
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Loads the problem into a new environment, with the same basis as the
+ * original problem. The copy is not reoptimized: with an iteration limit of
+ * zero, the dual simplex only factors the given basis, so that the copy
+ * keeps exactly the same basic variables as the original problem.
+ */
+static int load_problem_data(const struct ProblemData *data, struct LP *copy)
+{
+    int rval = 0;
+
+    rval = LP_open(copy);
+    abort_if(rval, "LP_open failed");
+
+    LP_disable_presolve(copy);
+
+    rval = CPXsetintparam(copy->cplex_env, CPX_PARAM_ITLIM, 0);
+    abort_if(rval, "CPXsetintparam failed");
+
+    rval = LP_create(copy, "tableau");
+    abort_if(rval, "LP_create failed");
+
+    rval = CPXcopylp(copy->cplex_env, copy->cplex_lp, data->ncols, data->nrows,
+            data->objsen, data->obj, data->rhs, data->sense, data->matbeg,
+            data->matcnt, data->matind, data->matval, data->lb, data->ub,
+            data->rngval);
+    abort_if(rval, "CPXcopylp failed");
+
+    rval = CPXcopybase(copy->cplex_env, copy->cplex_lp, data->cstat,
+            data->rstat);
+    abort_if(rval, "CPXcopybase failed");
+
+    rval = CPXdualopt(copy->cplex_env, copy->cplex_lp);
+    abort_if(rval, "CPXdualopt failed");
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Loads ncopies copies of the problem, each one into its own environment, so
+ * that LP_get_tableau_rows can extract rows from several threads. The copies
+ * should be freed with LP_free.
+ */
+int LP_load_tableau_copies(struct LP *lp,
+                           int ncopies,
+                           int *cstat,
+                           int *rstat,
+                           double *ub,
+                           double *lb,
+                           struct LP *copies)
+{
+    int rval = 0;
+    int *status = 0;
+
+    struct ProblemData data;
+    memset(&data, 0, sizeof(struct ProblemData));
+
+    for (int c = 0; c < ncopies; c++)
+    {
+        copies[c].cplex_env = 0;
+        copies[c].cplex_lp = 0;
+    }
+
+    if (ncopies <= 0) goto CLEANUP;
+
+    rval = read_problem_data(lp, cstat, rstat, ub, lb, &data);
+    abort_if(rval, "read_problem_data failed");
+
+    status = (int *) malloc(ncopies * sizeof(int));
+    abort_if(!status, "could not allocate status");
+
+    #pragma omp parallel for schedule(static, 1) num_threads(ncopies)
+    for (int c = 0; c < ncopies; c++)
+        status[c] = load_problem_data(&data, &copies[c]);
+
+    for (int c = 0; c < ncopies; c++)
+        abort_iff(status[c], "load_problem_data failed (copy %d)", c);
+
+CLEANUP:
+    if (rval)
+        for (int c = 0; c < ncopies; c++)
+            LP_free(&copies[c]);
+
+    free_problem_data(&data);
+    if (status) free(status);
+    return rval;
+}
+
+/*
+ * Extracts rows thread, thread + nthreads, thread + 2 * nthreads, etc. The
+ * first worker reads the original problem, while the other ones read their
+ * own copy of it. Since the copies may order the basic variables differently,
+ * rows are matched through their basic variables.
+ */
+static int extract_rows_worker(struct LP *lp,
+                               struct LP *copy,
+                               int ncols,
+                               int nrows,
+                               int thread,
+                               int nthreads,
+                               int count,
+                               const int *indices,
+                               const int *head,
+                               const double *rhs,
+                               int *cstat,
+                               double *ub,
+                               double *lb,
+                               struct Row **rows)
+{
+    int rval = 0;
+
+    struct LP *worker_lp = lp;
+
+    double *pi = 0;
+    int *copy_head = 0;
+    int *position = 0;
+
     pi = (double *) malloc(ncols * sizeof(double));
     abort_if(!pi, "could not allocate pi");
 
-    for (int i = 0; i < nrows; i++)
+    if (copy)
     {
-        int nz = 0;
-        rows[i] = (struct Row *) malloc(sizeof(struct Row));
-        abort_if(!rows[i], "could not allocate rows[i]");
+        worker_lp = copy;
 
-        struct Row *row = rows[i];
+        copy_head = (int *) malloc(nrows * sizeof(int));
+        position = (int *) malloc((ncols + nrows) * sizeof(int));
+        abort_if(!copy_head, "could not allocate copy_head");
+        abort_if(!position, "could not allocate position");
 
-        rval = CPXbinvarow(lp->cplex_env, lp->cplex_lp, i, pi);
-        abort_if(rval, "CPXbinvarow failed");
+        for (int k = 0; k < ncols + nrows; k++)
+            position[k] = -1;
 
-        for (int j = 0; j < ncols; j++)
-        {
-            if (fabs(pi[j]) < EPSILON)
-                continue;
+        rval = CPXgetbhead(copy->cplex_env, copy->cplex_lp, copy_head, 0);
+        abort_if(rval, "CPXgetbhead failed");
 
-            if (cstat[j] == CPX_AT_LOWER)
-                rhs[i] += lb[j] * pi[j];
+        for (int k = 0; k < nrows; k++)
+        {
+            int var = copy_head[k];
+            position[var >= 0 ? var : ncols - var - 1] = k;
+        }
+    }
 
-            if (cstat[j] == CPX_AT_UPPER)
-                rhs[i] += ub[j] * pi[j];
+    for (int k = thread; k < count; k += nthreads)
+    {
+        int i = indices[k];
+        int index = i;
 
-            nz++;
+        if (position)
+        {
+            index = position[head[i] >= 0 ? head[i] : ncols - head[i] - 1];
+            abort_iff(index < 0, "variable %d is not basic in the copy",
+                    head[i]);
         }
 
-        row->nz = nz;
-        row->pi_zero = rhs[i];
-        row->head = head[i];
+        rval = LP_get_tableau_row(worker_lp, index, head[i], rhs[i], cstat,
+                ub, lb, pi, rows[k]);
+        abort_if(rval, "LP_get_tableau_row failed");
+    }
 
-        row->pi = (double *) malloc(nz * sizeof(double));
-        row->indices = (int *) malloc(nz * sizeof(int));
+CLEANUP:
+    if (position) free(position);
+    if (copy_head) free(copy_head);
+    if (pi) free(pi);
+    return rval;
+}
 
-        abort_if(!row->pi, "could not allocate row->pi");
-        abort_if(!row->indices, "could not allocate row->indices");
+int LP_get_tableau_rows(struct LP *lp,
+                        int ncopies,
+                        struct LP *copies,
+                        int count,
+                        const int *indices,
+                        const int *head,
+                        const double *rhs,
+                        int *cstat,
+                        double *ub,
+                        double *lb,
+                        struct Row **rows)
+{
+    int rval = 0;
+    int *status = 0;
 
-        if (fabs(row->pi_zero) < EPSILON)
-            row->pi_zero = 0;
+    int ncols = LP_get_num_cols(lp);
+    int nrows = LP_get_num_rows(lp);
 
-        int k = 0;
-        for (int j = 0; j < ncols; j++)
-        {
-            if (fabs(pi[j]) < EPSILON)
-                continue;
+    for (int k = 0; k < count; k++)
+    {
+        rows[k]->pi = 0;
+        rows[k]->indices = 0;
+    }
 
-            row->pi[k] = pi[j];
-            row->indices[k++] = j;
-        }
+    int nthreads = max(1, min(ncopies + 1, count));
 
-        rval = LP_flip_row_coefficients(cstat, lb, ub, row);
-        abort_if(rval, "LP_flip_row_coefficients failed");
+    status = (int *) malloc(nthreads * sizeof(int));
+    abort_if(!status, "could not allocate status");
+
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads)
+    for (int t = 0; t < nthreads; t++)
+    {
+        struct LP *copy = (t > 0 ? &copies[t - 1] : 0);
+        status[t] = extract_rows_worker(lp, copy, ncols, nrows, t, nthreads,
+                count, indices, head, rhs, cstat, ub, lb, rows);
     }
 
+    for (int t = 0; t < nthreads; t++)
+        abort_iff(status[t], "extract_rows_worker failed (thread %d)", t);
+
 CLEANUP:
-    if(slacks) free(slacks);
+    if (status) free(status);
+    return rval;
+}
+
+int LP_get_tableau(struct LP *lp,
+                   struct Row **rows,
+                   int *cstat,
+                   int *rstat,
+                   double *ub,
+                   double *lb)
+{
+    int rval = 0;
+
+    int nrows = LP_get_num_rows(lp);
+
+    int *head = 0;
+    int *indices = 0;
+    double *rhs = 0;
+
+    for (int i = 0; i < nrows; i++)
+        rows[i] = 0;
+
+    rhs = (double *) malloc(nrows * sizeof(double));
+    head = (int *) malloc(nrows * sizeof(int));
+    indices = (int *) malloc(nrows * sizeof(int));
+
+    abort_if(!head, "could not allocate head");
+    abort_if(!rhs, "could not allocate rhs");
+    abort_if(!indices, "could not allocate indices");
+
+    rval = LP_get_basis_header(lp, head, rhs, cstat, rstat, ub, lb);
+    abort_if(rval, "LP_get_basis_header failed");
+
+    for (int i = 0; i < nrows; i++)
+    {
+        rows[i] = (struct Row *) malloc(sizeof(struct Row));
+        abort_if(!rows[i], "could not allocate rows[i]");
+        indices[i] = i;
+    }
+
+    rval = LP_get_tableau_rows(lp, 0, 0, nrows, indices, head, rhs, cstat,
+            ub, lb, rows);
+    abort_if(rval, "LP_get_tableau_rows failed");
+
+CLEANUP:
+    if (indices) free(indices);
     if (head) free(head);
     if (rhs) free(rhs);
-    if (pi) free(pi);
     return rval;
 }
 
@@ -722,6 +1262,64 @@ CLEANUP:
     return rval;
 }
 
+int LP_change_rhs_list(struct LP *lp,
+                       int count,
+                       const int *indices,
+                       const double *values)
+{
+    int rval = 0;
+
+    rval = CPXchgrhs(lp->cplex_env, lp->cplex_lp, count, indices, values);
+    abort_if(rval, "CPXchgrhs failed");
+
+CLEANUP:
+    return rval;
+}
+
+int LP_change_coefs(struct LP *lp,
+                    int count,
+                    const int *rows,
+                    const int *cols,
+                    const double *values)
+{
+    int rval = 0;
+
+    rval = CPXchgcoeflist(lp->cplex_env, lp->cplex_lp, count, rows, cols,
+            values);
+    abort_if(rval, "CPXchgcoeflist failed");
+
+CLEANUP:
+    return rval;
+}
+
+/*
+ * Replaces the MIP starts of the problem by the given partial solution. The
+ * remaining variables are computed by CPLEX, with the given ones fixed.
+ */
+int LP_set_mip_start(struct LP *lp,
+                     int nz,
+                     const int *indices,
+                     const double *values)
+{
+    int rval = 0;
+    int beg = 0;
+    int effort = CPX_MIPSTART_SOLVEFIXED;
+    int count = CPXgetnummipstarts(lp->cplex_env, lp->cplex_lp);
+
+    if (count > 0)
+    {
+        rval = CPXdelmipstarts(lp->cplex_env, lp->cplex_lp, 0, count - 1);
+        abort_if(rval, "CPXdelmipstarts failed");
+    }
+
+    rval = CPXaddmipstarts(lp->cplex_env, lp->cplex_lp, 1, nz, &beg, indices,
+            values, &effort, NULL);
+    abort_if(rval, "CPXaddmipstarts failed");
+
+CLEANUP:
+    return rval;
+}
+
 int LP_init_row(struct Row *row, int nz_capacity)
 {
     int rval = 0;
@@ -0,0 +1,680 @@
+/* Copyright (c) 2015-2017 Alinson Xavier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <multirow/lu.h>
+#include <multirow/util.h>
+
+/*
+ * Pivots must be at least this fraction of the largest entry in their row.
+ */
+#define LU_PIVOT_THRESHOLD 0.1
+
+/*
+ * Entries smaller than this are dropped from the active submatrix.
+ */
+#define LU_DROP_TOLERANCE 1e-14
+
+struct SparseRow
+{
+    int nz;
+    int capacity;
+    int *indices;
+    double *values;
+};
+
+struct IntList
+{
+    int n;
+    int capacity;
+    int *items;
+};
+
+/*
+ * Active rows, grouped in doubly-linked lists according to their number of
+ * nonzeros, so that the sparsest row can be found quickly.
+ */
+struct RowBuckets
+{
+    int *first;
+    int *next;
+    int *prev;
+};
+
+static int row_push(struct SparseRow *row, int index, double value)
+{
+    int rval = 0;
+
+    if (row->nz >= row->capacity)
+    {
+        int capacity = max(4, 2 * row->capacity);
+
+        row->indices = (int *) realloc(row->indices, capacity * sizeof(int));
+        row->values = (double *) realloc(row->values,
+                capacity * sizeof(double));
+        abort_if(!row->indices, "could not allocate row->indices");
+        abort_if(!row->values, "could not allocate row->values");
+
+        row->capacity = capacity;
+    }
+
+    row->indices[row->nz] = index;
+    row->values[row->nz] = value;
+    row->nz++;
+
+CLEANUP:
+    return rval;
+}
+
+static void row_free(struct SparseRow *row)
+{
+    if (row->indices) free(row->indices);
+    if (row->values) free(row->values);
+    row->indices = 0;
+    row->values = 0;
+    row->nz = row->capacity = 0;
+}
+
+static int list_push(struct IntList *list, int item)
+{
+    int rval = 0;
+
+    if (list->n >= list->capacity)
+    {
+        int capacity = max(4, 2 * list->capacity);
+
+        list->items = (int *) realloc(list->items, capacity * sizeof(int));
+        abort_if(!list->items, "could not allocate list->items");
+
+        list->capacity = capacity;
+    }
+
+    list->items[list->n++] = item;
+
+CLEANUP:
+    return rval;
+}
+
+static void bucket_insert(struct RowBuckets *buckets, int count, int i)
+{
+    buckets->prev[i] = -1;
+    buckets->next[i] = buckets->first[count];
+
+    if (buckets->first[count] >= 0)
+        buckets->prev[buckets->first[count]] = i;
+
+    buckets->first[count] = i;
+}
+
+static void bucket_remove(struct RowBuckets *buckets, int count, int i)
+{
+    if (buckets->prev[i] >= 0)
+        buckets->next[buckets->prev[i]] = buckets->next[i];
+    else
+        buckets->first[count] = buckets->next[i];
+
+    if (buckets->next[i] >= 0)
+        buckets->prev[buckets->next[i]] = buckets->prev[i];
+}
+
+/*
+ * Chooses the pivot in the given row: among the entries that are large
+ * enough, the one whose column has fewest nonzeros in the active submatrix.
+ */
+static int choose_pivot(const struct SparseRow *row, const int *col_count)
+{
+    int best = -1;
+    double largest = 0;
+
+    for (int l = 0; l < row->nz; l++)
+        largest = fmax(largest, fabs(row->values[l]));
+
+    for (int l = 0; l < row->nz; l++)
+    {
+        double v = fabs(row->values[l]);
+        if (v < LU_PIVOT_THRESHOLD * largest) continue;
+
+        if (best >= 0)
+        {
+            int c = col_count[row->indices[l]];
+            int best_c = col_count[row->indices[best]];
+
+            if (c > best_c) continue;
+            if (c == best_c && v <= fabs(row->values[best])) continue;
+        }
+
+        best = l;
+    }
+
+    return best;
+}
+
+/*
+ * Subtracts multiplier times the pivot row from the given row, which must
+ * contain the pivot column. Entries of the row are indexed by position,
+ * which is left filled with -1.
+ */
+static int eliminate_row(struct SparseRow *row,
+                         int r,
+                         const struct SparseRow *pivot_row,
+                         int pivot_col,
+                         double multiplier,
+                         int *position,
+                         int *col_count,
+                         struct IntList *col_rows)
+{
+    int rval = 0;
+    int nz = 0;
+
+    for (int l = 0; l < pivot_row->nz; l++)
+    {
+        int c = pivot_row->indices[l];
+        double v = multiplier * pivot_row->values[l];
+
+        if (c == pivot_col) continue;
+
+        if (position[c] >= 0)
+        {
+            row->values[position[c]] -= v;
+        }
+        else
+        {
+            rval = row_push(row, c, -v);
+            abort_if(rval, "row_push failed");
+
+            rval = list_push(&col_rows[c], r);
+            abort_if(rval, "list_push failed");
+
+            position[c] = row->nz - 1;
+            col_count[c]++;
+        }
+    }
+
+    for (int l = 0; l < row->nz; l++)
+    {
+        int c = row->indices[l];
+        double v = row->values[l];
+
+        position[c] = -1;
+
+        if (c == pivot_col) continue;
+
+        if (fabs(v) < LU_DROP_TOLERANCE)
+        {
+            col_count[c]--;
+            continue;
+        }
+
+        row->indices[nz] = c;
+        row->values[nz] = v;
+        nz++;
+    }
+
+    row->nz = nz;
+
+CLEANUP:
+    return rval;
+}
+
+int LU_factor(int n,
+              const int *row_start,
+              const int *indices,
+              const double *values,
+              struct LU *lu)
+{
+    int rval = 0;
+
+    struct SparseRow *rows = 0;
+    struct IntList *col_rows = 0;
+    struct RowBuckets buckets = {0, 0, 0};
+    struct SparseRow u = {0, 0, 0, 0};
+    struct SparseRow l = {0, 0, 0, 0};
+
+    int *col_count = 0;
+    int *row_step = 0;
+    int *position = 0;
+    int *mark = 0;
+
+    memset(lu, 0, sizeof(struct LU));
+    lu->n = n;
+
+    lu->pivot_row = (int *) malloc(n * sizeof(int));
+    lu->pivot_col = (int *) malloc(n * sizeof(int));
+    lu->u_pivot = (double *) malloc(n * sizeof(double));
+    lu->u_start = (int *) malloc((n + 1) * sizeof(int));
+    lu->l_start = (int *) malloc((n + 1) * sizeof(int));
+
+    abort_if(!lu->pivot_row, "could not allocate pivot_row");
+    abort_if(!lu->pivot_col, "could not allocate pivot_col");
+    abort_if(!lu->u_pivot, "could not allocate u_pivot");
+    abort_if(!lu->u_start, "could not allocate u_start");
+    abort_if(!lu->l_start, "could not allocate l_start");
+
+    rows = (struct SparseRow *) calloc(n, sizeof(struct SparseRow));
+    col_rows = (struct IntList *) calloc(n, sizeof(struct IntList));
+    col_count = (int *) calloc(n, sizeof(int));
+    row_step = (int *) malloc(n * sizeof(int));
+    position = (int *) malloc(n * sizeof(int));
+    mark = (int *) malloc(n * sizeof(int));
+    buckets.first = (int *) malloc((n + 1) * sizeof(int));
+    buckets.next = (int *) malloc(n * sizeof(int));
+    buckets.prev = (int *) malloc(n * sizeof(int));
+
+    abort_if(!rows, "could not allocate rows");
+    abort_if(!col_rows, "could not allocate col_rows");
+    abort_if(!col_count, "could not allocate col_count");
+    abort_if(!row_step, "could not allocate row_step");
+    abort_if(!position, "could not allocate position");
+    abort_if(!mark, "could not allocate mark");
+    abort_if(!buckets.first, "could not allocate buckets.first");
+    abort_if(!buckets.next, "could not allocate buckets.next");
+    abort_if(!buckets.prev, "could not allocate buckets.prev");
+
+    for (int i = 0; i <= n; i++)
+        buckets.first[i] = -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        row_step[i] = -1;
+        position[i] = -1;
+        mark[i] = -1;
+
+        for (int k = row_start[i]; k < row_start[i + 1]; k++)
+        {
+            if (values[k] == 0) continue;
+
+            rval = row_push(&rows[i], indices[k], values[k]);
+            abort_if(rval, "row_push failed");
+
+            rval = list_push(&col_rows[indices[k]], i);
+            abort_if(rval, "list_push failed");
+
+            col_count[indices[k]]++;
+        }
+
+        bucket_insert(&buckets, rows[i].nz, i);
+    }
+
+    for (int p = 0; p < n; p++)
+    {
+        int i = -1;
+        for (int count = 0; count <= n && i < 0; count++)
+            i = buckets.first[count];
+
+        struct SparseRow *pr = &rows[i];
+        abort_iff(pr->nz == 0, "singular matrix (step %d)", p);
+
+        int best = choose_pivot(pr, col_count);
+        int pc = pr->indices[best];
+        double pivot = pr->values[best];
+
+        bucket_remove(&buckets, pr->nz, i);
+        row_step[i] = p;
+
+        lu->pivot_row[p] = i;
+        lu->pivot_col[p] = pc;
+        lu->u_pivot[p] = pivot;
+        lu->u_start[p] = u.nz;
+        lu->l_start[p] = l.nz;
+
+        for (int k = 0; k < pr->nz; k++)
+        {
+            col_count[pr->indices[k]]--;
+            if (k == best) continue;
+
+            rval = row_push(&u, pr->indices[k], pr->values[k]);
+            abort_if(rval, "row_push failed");
+        }
+
+        for (int k = 0; k < col_rows[pc].n; k++)
+        {
+            int r = col_rows[pc].items[k];
+            if (row_step[r] >= 0 || mark[r] == p) continue;
+            mark[r] = p;
+
+            struct SparseRow *row = &rows[r];
+            int old_nz = row->nz;
+
+            for (int t = 0; t < row->nz; t++)
+                position[row->indices[t]] = t;
+
+            if (position[pc] < 0)
+            {
+                for (int t = 0; t < row->nz; t++)
+                    position[row->indices[t]] = -1;
+                continue;
+            }
+
+            double multiplier = row->values[position[pc]] / pivot;
+
+            rval = eliminate_row(row, r, pr, pc, multiplier, position,
+                    col_count, col_rows);
+            abort_if(rval, "eliminate_row failed");
+
+            bucket_remove(&buckets, old_nz, r);
+            bucket_insert(&buckets, row->nz, r);
+
+            rval = row_push(&l, r, multiplier);
+            abort_if(rval, "row_push failed");
+        }
+
+        row_free(pr);
+        free(col_rows[pc].items);
+        col_rows[pc].items = 0;
+        col_rows[pc].n = col_rows[pc].capacity = 0;
+    }
+
+    lu->u_start[n] = u.nz;
+    lu->u_indices = u.indices;
+    lu->u_values = u.values;
+    u.indices = 0;
+    u.values = 0;
+
+    lu->l_start[n] = l.nz;
+    lu->l_rows = l.indices;
+    lu->l_values = l.values;
+    l.indices = 0;
+    l.values = 0;
+
+CLEANUP:
+    if (rval) LU_free(lu);
+    row_free(&u);
+    row_free(&l);
+    if (rows)
+    {
+        for (int i = 0; i < n; i++)
+            row_free(&rows[i]);
+        free(rows);
+    }
+    if (col_rows)
+    {
+        for (int j = 0; j < n; j++)
+            if (col_rows[j].items) free(col_rows[j].items);
+        free(col_rows);
+    }
+    if (buckets.first) free(buckets.first);
+    if (buckets.next) free(buckets.next);
+    if (buckets.prev) free(buckets.prev);
+    if (col_count) free(col_count);
+    if (row_step) free(row_step);
+    if (position) free(position);
+    if (mark) free(mark);
+    return rval;
+}
+
+void LU_free(struct LU *lu)
+{
+    if (!lu) return;
+    if (lu->pivot_row) free(lu->pivot_row);
+    if (lu->pivot_col) free(lu->pivot_col);
+    if (lu->u_pivot) free(lu->u_pivot);
+    if (lu->u_start) free(lu->u_start);
+    if (lu->u_indices) free(lu->u_indices);
+    if (lu->u_values) free(lu->u_values);
+    if (lu->l_start) free(lu->l_start);
+    if (lu->l_rows) free(lu->l_rows);
+    if (lu->l_values) free(lu->l_values);
+    memset(lu, 0, sizeof(struct LU));
+}
+
+/*
+ * Since B = L U, where row p of U is indexed by the columns of B, the system
+ * is solved as U^T z = b, followed by L^T y = z. Component z_p is stored at
+ * b[pivot_col[p]], which is not read after step p.
+ */
+void LU_solve_transposed(const struct LU *lu, double *b, double *y)
+{
+    for (int p = 0; p < lu->n; p++)
+    {
+        int c = lu->pivot_col[p];
+        double z = b[c] / lu->u_pivot[p];
+
+        b[c] = z;
+        if (z == 0) continue;
+
+        for (int k = lu->u_start[p]; k < lu->u_start[p + 1]; k++)
+            b[lu->u_indices[k]] -= lu->u_values[k] * z;
+    }
+
+    for (int p = lu->n - 1; p >= 0; p--)
+    {
+        double v = b[lu->pivot_col[p]];
+
+        for (int k = lu->l_start[p]; k < lu->l_start[p + 1]; k++)
+            v -= lu->l_values[k] * y[lu->l_rows[k]];
+
+        y[lu->pivot_row[p]] = v;
+    }
+}
+
+int LU_tableau_init(struct LP *lp,
+                    const int *head,
+                    struct LUTableau *tableau)
+{
+    int rval = 0;
+    int nz = 0, surplus = 0;
+
+    int nrows = LP_get_num_rows(lp);
+    int ncols = LP_get_num_cols(lp);
+
+    int *basis_position = 0;
+    int *b_start = 0;
+    int *b_indices = 0;
+    double *b_values = 0;
+
+    tableau->nrows = nrows;
+    tableau->ncols = ncols;
+    tableau->indices = 0;
+    tableau->values = 0;
+    memset(&tableau->lu, 0, sizeof(struct LU));
+
+    tableau->row_start = (int *) malloc((nrows + 1) * sizeof(int));
+    basis_position = (int *) malloc((ncols + nrows) * sizeof(int));
+    b_start = (int *) malloc((nrows + 1) * sizeof(int));
+
+    abort_if(!tableau->row_start, "could not allocate row_start");
+    abort_if(!basis_position, "could not allocate basis_position");
+    abort_if(!b_start, "could not allocate b_start");
+
+    rval = CPXgetrows(lp->cplex_env, lp->cplex_lp, &nz, tableau->row_start, 0,
+            0, 0, &surplus, 0, nrows - 1);
+    abort_if(rval && rval != CPXERR_NEGATIVE_SURPLUS, "CPXgetrows failed");
+
+    int space = -surplus;
+    tableau->indices = (int *) malloc(max(space, 1) * sizeof(int));
+    tableau->values = (double *) malloc(max(space, 1) * sizeof(double));
+    abort_if(!tableau->indices, "could not allocate indices");
+    abort_if(!tableau->values, "could not allocate values");
+
+    rval = CPXgetrows(lp->cplex_env, lp->cplex_lp, &nz, tableau->row_start,
+            tableau->indices, tableau->values, space, &surplus, 0, nrows - 1);
+    abort_if(rval, "CPXgetrows failed");
+
+    tableau->row_start[nrows] = nz;
+
+    /* Basis columns are indexed by their position in the header. Slack
+     * variables, encoded by CPLEX as -r-1, are stored after the structural
+     * variables and have column e_r in the constraint matrix. */
+    for (int j = 0; j < ncols + nrows; j++)
+        basis_position[j] = -1;
+
+    for (int k = 0; k < nrows; k++)
+        basis_position[head[k] >= 0 ? head[k] : ncols - head[k] - 1] = k;
+
+    b_indices = (int *) malloc((nz + nrows) * sizeof(int));
+    b_values = (double *) malloc((nz + nrows) * sizeof(double));
+    abort_if(!b_indices, "could not allocate b_indices");
+    abort_if(!b_values, "could not allocate b_values");
+
+    int b_nz = 0;
+    for (int r = 0; r < nrows; r++)
+    {
+        b_start[r] = b_nz;
+
+        for (int k = tableau->row_start[r]; k < tableau->row_start[r + 1]; k++)
+        {
+            int position = basis_position[tableau->indices[k]];
+            if (position < 0) continue;
+
+            b_indices[b_nz] = position;
+            b_values[b_nz] = tableau->values[k];
+            b_nz++;
+        }
+
+        if (basis_position[ncols + r] >= 0)
+        {
+            b_indices[b_nz] = basis_position[ncols + r];
+            b_values[b_nz] = 1.0;
+            b_nz++;
+        }
+    }
+    b_start[nrows] = b_nz;
+
+    rval = LU_factor(nrows, b_start, b_indices, b_values, &tableau->lu);
+    abort_if(rval, "LU_factor failed");
+
+    log_debug("    LU: %d nonzeros in B, %d in L, %d in U\n", b_nz,
+            tableau->lu.l_start[nrows], tableau->lu.u_start[nrows] + nrows);
+
+CLEANUP:
+    if (rval) LU_tableau_free(tableau);
+    if (basis_position) free(basis_position);
+    if (b_start) free(b_start);
+    if (b_indices) free(b_indices);
+    if (b_values) free(b_values);
+    return rval;
+}
+
+void LU_tableau_free(struct LUTableau *tableau)
+{
+    if (!tableau) return;
+    if (tableau->row_start) free(tableau->row_start);
+    if (tableau->indices) free(tableau->indices);
+    if (tableau->values) free(tableau->values);
+    tableau->row_start = 0;
+    tableau->indices = 0;
+    tableau->values = 0;
+    LU_free(&tableau->lu);
+}
+
+void LU_tableau_row(const struct LUTableau *tableau,
+                    int index,
+                    double *work,
+                    double *y,
+                    double *pi)
+{
+    memset(work, 0, tableau->nrows * sizeof(double));
+    memset(pi, 0, tableau->ncols * sizeof(double));
+
+    work[index] = 1.0;
+    LU_solve_transposed(&tableau->lu, work, y);
+
+    for (int r = 0; r < tableau->nrows; r++)
+    {
+        double yr = y[r];
+        if (yr == 0) continue;
+
+        for (int k = tableau->row_start[r]; k < tableau->row_start[r + 1]; k++)
+            pi[tableau->indices[k]] += yr * tableau->values[k];
+    }
+}
+
+static int tableau_rows_worker(const struct LUTableau *tableau,
+                               int thread,
+                               int nthreads,
+                               int count,
+                               const int *indices,
+                               const int *head,
+                               const double *rhs,
+                               int *cstat,
+                               double *ub,
+                               double *lb,
+                               struct Row **rows)
+{
+    int rval = 0;
+
+    double *work = 0;
+    double *y = 0;
+    double *pi = 0;
+
+    work = (double *) malloc(tableau->nrows * sizeof(double));
+    y = (double *) malloc(tableau->nrows * sizeof(double));
+    pi = (double *) malloc(tableau->ncols * sizeof(double));
+
+    abort_if(!work, "could not allocate work");
+    abort_if(!y, "could not allocate y");
+    abort_if(!pi, "could not allocate pi");
+
+    for (int k = thread; k < count; k += nthreads)
+    {
+        int i = indices[k];
+
+        LU_tableau_row(tableau, i, work, y, pi);
+
+        rval = LP_tableau_row_from_dense(tableau->ncols, pi, head[i], rhs[i],
+                cstat, ub, lb, rows[k]);
+        abort_if(rval, "LP_tableau_row_from_dense failed");
+    }
+
+CLEANUP:
+    if (work) free(work);
+    if (y) free(y);
+    if (pi) free(pi);
+    return rval;
+}
+
+int LU_tableau_rows(const struct LUTableau *tableau,
+                    int nthreads,
+                    int count,
+                    const int *indices,
+                    const int *head,
+                    const double *rhs,
+                    int *cstat,
+                    double *ub,
+                    double *lb,
+                    struct Row **rows)
+{
+    int rval = 0;
+    int *status = 0;
+
+    for (int k = 0; k < count; k++)
+    {
+        rows[k]->pi = 0;
+        rows[k]->indices = 0;
+    }
+
+    nthreads = max(1, min(nthreads, count));
+
+    status = (int *) malloc(nthreads * sizeof(int));
+    abort_if(!status, "could not allocate status");
+
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads)
+    for (int t = 0; t < nthreads; t++)
+    {
+        status[t] = tableau_rows_worker(tableau, t, nthreads, count, indices,
+                head, rhs, cstat, ub, lb, rows);
+    }
+
+    for (int t = 0; t < nthreads; t++)
+        abort_iff(status[t], "tableau_rows_worker failed (thread %d)", t);
+
+CLEANUP:
+    if (status) free(status);
+    return rval;
+}
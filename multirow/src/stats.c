@@ -26,6 +26,8 @@ char input_filename[MAX_LENGTH];
 
 unsigned long long generated_cuts_count[MAX_LENGTH];
 unsigned long long added_cuts_count[MAX_LENGTH];
+unsigned long long pooled_cuts_count[MAX_ROUNDS];
+unsigned long long lp_solves_count[MAX_ROUNDS];
 
 int n_rounds = 0;
 unsigned long long total_added_cuts = 0;
@@ -36,6 +38,14 @@ double obj_value[MAX_ROUNDS];
 double prev_time;
 double runtime[MAX_ROUNDS];
 
+unsigned long long lfree_2d_validated_count = 0;
+unsigned long long lfree_2d_mismatch_count = 0;
+double lfree_2d_nd_time = 0;
+double lfree_2d_fast_time = 0;
+
+unsigned long long lfree_cache_hits = 0;
+unsigned long long lfree_cache_misses = 0;
+
 void STATS_init()
 {
     for(int i = 0; i < MAX_ROUNDS; i++)
@@ -43,6 +53,8 @@ void STATS_init()
         obj_value[i] = NAN;
         generated_cuts_count[i] = 0;
         added_cuts_count[i] = 0;
+        pooled_cuts_count[i] = 0;
+        lp_solves_count[i] = 0;
         runtime[i] = 0;
     }
 
@@ -71,6 +83,36 @@ void STATS_increment_added_cuts()
     total_added_cuts++;
 }
 
+void STATS_increment_pooled_cuts()
+{
+    pooled_cuts_count[n_rounds]++;
+}
+
+void STATS_increment_lp_solves()
+{
+    lp_solves_count[n_rounds]++;
+}
+
+void STATS_add_lfree_2d_validation(double nd_time, double fast_time, int agree)
+{
+    #pragma omp critical(stats)
+    {
+        lfree_2d_validated_count++;
+        if(!agree) lfree_2d_mismatch_count++;
+        lfree_2d_nd_time += nd_time;
+        lfree_2d_fast_time += fast_time;
+    }
+}
+
+void STATS_add_lfree_cache_lookup(int hit)
+{
+    #pragma omp critical(stats)
+    {
+        if(hit) lfree_cache_hits++;
+        else lfree_cache_misses++;
+    }
+}
+
 void STATS_finish_round()
 {
     double now = get_user_time();
@@ -101,6 +143,18 @@ int STATS_print_yaml(char *filename)
     for(int i = 0; i < n_rounds; i++)
         fprintf(f, "  %d: %lld\n", i, added_cuts_count[i]);
 
+    fprintf(f, "pooled-cuts:\n");
+    for(int i = 0; i < n_rounds; i++)
+        fprintf(f, "  %d: %lld\n", i, pooled_cuts_count[i]);
+
+    fprintf(f, "lp-solves:\n");
+    for(int i = 0; i < n_rounds; i++)
+        fprintf(f, "  %d: %lld\n", i, lp_solves_count[i]);
+
+    fprintf(f, "lp-solves-saved:\n");
+    for(int i = 0; i < n_rounds; i++)
+        fprintf(f, "  %d: %lld\n", i, pooled_cuts_count[i] - lp_solves_count[i]);
+
     fprintf(f, "user-cpu-time:\n");
     for(int i = 0; i < n_rounds; i++)
         fprintf(f, "  %d: %.3lf\n", i, runtime[i]);
@@ -112,6 +166,26 @@ int STATS_print_yaml(char *filename)
             fprintf(f, "  %d: %.3lf\n", i, runtime[i] / generated_cuts_count[i]);
     }
 
+    if(lfree_2d_validated_count > 0)
+    {
+        fprintf(f, "lfree-2d-validation:\n");
+        fprintf(f, "  sets: %lld\n", lfree_2d_validated_count);
+        fprintf(f, "  mismatches: %lld\n", lfree_2d_mismatch_count);
+        fprintf(f, "  nd-time: %.6lf\n", lfree_2d_nd_time);
+        fprintf(f, "  fast-time: %.6lf\n", lfree_2d_fast_time);
+        fprintf(f, "  speedup: %.2lf\n",
+                lfree_2d_nd_time / fmax(lfree_2d_fast_time, 1e-9));
+    }
+
+    if(lfree_cache_hits + lfree_cache_misses > 0)
+    {
+        fprintf(f, "lfree-cache:\n");
+        fprintf(f, "  hits: %lld\n", lfree_cache_hits);
+        fprintf(f, "  misses: %lld\n", lfree_cache_misses);
+        fprintf(f, "  hit-rate: %.4lf\n", (double) lfree_cache_hits /
+                (lfree_cache_hits + lfree_cache_misses));
+    }
+
     fclose(f);
 
 CLEANUP:
@@ -37,9 +37,30 @@ double get_user_time()
            + ((double) ru.ru_utime.tv_usec) / 1000000.0;
 }
 
+/**
+ * Returns the CPU time consumed by the calling thread, in seconds. Unlike
+ * get_user_time, this is not affected by other threads of the process.
+ */
+double get_thread_time()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return ((double) ts.tv_sec) + ((double) ts.tv_nsec) / 1000000000.0;
+}
+
+/**
+ * Returns the time elapsed since an arbitrary fixed point, in seconds, from
+ * a monotonic clock. Only differences between two calls are meaningful.
+ */
 double get_real_time()
 {
-    return (double) time (0);
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((double) ts.tv_sec) + ((double) ts.tv_nsec) / 1000000000.0;
 }
 
 void time_printf(const char *fmt,
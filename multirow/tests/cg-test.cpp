@@ -26,7 +26,12 @@ extern "C" {
 
 int BOOST_VAR = -1;
 double BOOST_FACTOR = 1.0;
-int SHOULD_DUMP_CUTS = 0;
+int N_THREADS = 1;
+int CUT_POOL_SIZE = 0;
+int CUT_BATCH_SIZE = 1;
+int CUT_SELECTION = CUT_SELECTION_VIOLATION;
+int TABLEAU_ENGINE = TABLEAU_ENGINE_CPLEX;
+int LFREE_2D_ALGORITHM = LFREE_2D_ALGORITHM_FAST;
 
 TEST(CGTest, next_combination_test_1)
 {
@@ -248,3 +253,157 @@ TEST(CGTest, boost_variable_test)
 CLEANUP:
     if(rval) FAIL();
 }
+
+TEST(CGTest, pool_rank_test)
+{
+    int rval = 0;
+    int order[3];
+
+    double pi1[] = { 1.0, 1.0 };
+    int indices1[] = { 0, 1 };
+    struct Row cut1 = {.nz = 2, .head = 0, .pi_zero = 0.0, .pi = pi1, .indices = indices1};
+
+    double pi2[] = { 4.0, 1.0 };
+    int indices2[] = { 0, 1 };
+    struct Row cut2 = {.nz = 2, .head = 0, .pi_zero = 0.0, .pi = pi2, .indices = indices2};
+
+    double pi3[] = { 1.0 };
+    int indices3[] = { 0 };
+    struct Row cut3 = {.nz = 1, .head = 0, .pi_zero = 0.0, .pi = pi3, .indices = indices3};
+
+    double pi4[] = { 0.0 };
+    int indices4[] = { 0 };
+    struct Row zero_cut = {.nz = 1, .head = 0, .pi_zero = -1.0, .pi = pi4, .indices = indices4};
+
+    struct CutPool pool;
+
+    rval = pool_init(&pool, 3);
+    abort_if(rval, "pool_init failed");
+
+    rval = pool_push(&pool, &cut1, 2.0, cut_norm(&cut1));
+    abort_if(rval, "pool_push failed");
+
+    rval = pool_push(&pool, &cut2, 10.0, cut_norm(&cut2));
+    abort_if(rval, "pool_push failed");
+
+    rval = pool_push(&pool, &cut3, 1.0, cut_norm(&cut3));
+    abort_if(rval, "pool_push failed");
+
+    EXPECT_EQ(cut_norm(&zero_cut), 0.0);
+
+    EXPECT_EQ(pool.ncuts, 3);
+    EXPECT_NEAR(pool.violation[0], 2.0 / sqrt(2.0), 1e-8);
+    EXPECT_NEAR(pool.violation[1], 10.0 / sqrt(17.0), 1e-8);
+    EXPECT_NEAR(pool.dynamism[1], 4.0, 1e-8);
+
+    rval = pool_rank(&pool, CUT_SELECTION_VIOLATION, order);
+    abort_if(rval, "pool_rank failed");
+
+    EXPECT_EQ(order[0], 1);
+    EXPECT_EQ(order[1], 0);
+    EXPECT_EQ(order[2], 2);
+
+    rval = pool_rank(&pool, CUT_SELECTION_DYNAMISM, order);
+    abort_if(rval, "pool_rank failed");
+
+    EXPECT_EQ(order[0], 0);
+    EXPECT_EQ(order[1], 2);
+    EXPECT_EQ(order[2], 1);
+
+CLEANUP:
+    pool_free(&pool);
+    if(rval) FAIL();
+}
+
+TEST(CGTest, find_combinations_test)
+{
+    int rval = 0;
+
+    double pi[] = { 1.0, 1.0 };
+
+    int indices0[] = { 0, 1 };
+    int indices1[] = { 0, 1 };
+    int indices2[] = { 2, 3 };
+    int indices3[] = { 0, 2 };
+
+    struct Row row0 = {.nz = 2, .head = 0, .pi_zero = 0.5, .pi = pi, .indices = indices0};
+    struct Row row1 = {.nz = 2, .head = 1, .pi_zero = 0.5, .pi = pi, .indices = indices1};
+    struct Row row2 = {.nz = 2, .head = 2, .pi_zero = 0.5, .pi = pi, .indices = indices2};
+    struct Row row3 = {.nz = 2, .head = 3, .pi_zero = 0.0, .pi = pi, .indices = indices3};
+
+    struct Row *rows[] = { &row0, &row1, &row2, &row3 };
+    int row_selected[] = { 1, 1, 1, 1 };
+
+    struct CG cg;
+    cg.nrows = 4;
+    cg.tableau_rows = rows;
+
+    int combinations[20];
+    long ncombinations;
+
+    rval = find_combinations(&cg, 2, row_selected, combinations,
+            &ncombinations);
+    abort_if(rval, "find_combinations failed");
+
+    EXPECT_EQ(ncombinations, 4);
+
+    EXPECT_EQ(combinations[0], 1);
+    EXPECT_EQ(combinations[1], 0);
+    EXPECT_EQ(combinations[2], 3);
+    EXPECT_EQ(combinations[3], 0);
+    EXPECT_EQ(combinations[4], 3);
+    EXPECT_EQ(combinations[5], 1);
+    EXPECT_EQ(combinations[6], 3);
+    EXPECT_EQ(combinations[7], 2);
+
+CLEANUP:
+    if(rval) FAIL();
+}
+
+TEST(CGTest, affinity_get_test)
+{
+    int rval = 0;
+
+    double pi[] = { 1.0, 1.0, 1.0 };
+
+    int indices0[] = { 0, 1, 2 };
+    int indices1[] = { 0, 1, 5 };
+    int indices2[] = { 3, 4, 5 };
+
+    struct Row row0 = {.nz = 3, .head = 0, .pi_zero = 0.5, .pi = pi, .indices = indices0};
+    struct Row row1 = {.nz = 3, .head = 1, .pi_zero = 0.5, .pi = pi, .indices = indices1};
+    struct Row row2 = {.nz = 3, .head = 2, .pi_zero = 0.5, .pi = pi, .indices = indices2};
+
+    struct Row *rows[] = { &row0, &row1, &row2 };
+    int selected[] = { 0, 1, 2 };
+    double cutoffs[] = { 0.25, 0.50, 0.75 };
+
+    struct CG cg;
+    cg.nrows = 3;
+    cg.tableau_rows = rows;
+
+    struct RowAffinity affinity;
+    int level;
+
+    rval = affinity_init(&affinity, &cg, 3, selected, 3, cutoffs);
+    abort_if(rval, "affinity_init failed");
+
+    for (int k = 0; k < 3; k++)
+        EXPECT_EQ(affinity.levels[k], AFFINITY_UNKNOWN);
+
+    rval = affinity_get(&affinity, 1, 0, &level);
+    abort_if(rval, "affinity_get failed");
+    EXPECT_EQ(level, 2);
+
+    rval = affinity_get(&affinity, 0, 2, &level);
+    abort_if(rval, "affinity_get failed");
+    EXPECT_EQ(level, 0);
+
+    EXPECT_EQ(affinity.levels[0], 2);
+    EXPECT_EQ(affinity.levels[1], 0);
+    EXPECT_EQ(affinity.levels[2], AFFINITY_UNKNOWN);
+
+CLEANUP:
+    affinity_free(&affinity);
+    if(rval) FAIL();
+}
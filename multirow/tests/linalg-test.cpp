@@ -104,4 +104,54 @@ TEST(LinAlgTest, solve_test_2)
 
 CLEANUP:
     if(rval) FAIL();
-}
\ No newline at end of file
+}
+TEST(LinAlgTest, max_product_test)
+{
+    int rval = 0;
+
+    double H[] = {
+            1.0,  0.0,
+            0.0,  1.0,
+           -1.0, -1.0,
+    };
+    double R[] = {
+            2.0,  3.0,
+           -1.0, -2.0,
+            0.5, -4.0,
+    };
+    double y[3];
+
+    rval = LINALG_max_product(3, 3, 2, H, R, y);
+    abort_if(rval, "LINALG_max_product failed");
+
+    EXPECT_NEAR(y[0], 3.0, E);
+    EXPECT_NEAR(y[1], 3.0, E);
+    EXPECT_NEAR(y[2], 3.5, E);
+
+CLEANUP:
+    if(rval) FAIL();
+}
+
+TEST(LinAlgTest, max_product_test_2)
+{
+    int rval = 0;
+
+    double H[] = {
+            1.0, 0.0, 0.0,  0.0,
+            0.0, 0.0, 0.0, -2.0,
+    };
+    double R[] = {
+            1.0, 2.0, 3.0,  4.0,
+            5.0, 6.0, 7.0, -8.0,
+    };
+    double y[2];
+
+    rval = LINALG_max_product(2, 2, 4, H, R, y);
+    abort_if(rval, "LINALG_max_product failed");
+
+    EXPECT_NEAR(y[0], 1.0, E);
+    EXPECT_NEAR(y[1], 16.0, E);
+
+CLEANUP:
+    if(rval) FAIL();
+}
@@ -0,0 +1,70 @@
+/* Copyright (c) 2015-2017 Alinson Xavier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <multirow/util.h>
+#include <multirow/lu.h>
+}
+
+const double E = 1e-6;
+
+TEST(LUTest, solve_transposed_test)
+{
+    int rval = 0;
+    struct LU lu;
+
+    // B = [ 0  2  0  1 ]
+    //     [ 1  0  0  0 ]
+    //     [ 0  3  4  0 ]
+    //     [ 2  0  1 -1 ]
+    int row_start[] = { 0, 2, 3, 5, 8 };
+    int indices[] = { 1, 3, 0, 1, 2, 0, 2, 3 };
+    double values[] = { 2.0, 1.0, 1.0, 3.0, 4.0, 2.0, 1.0, -1.0 };
+
+    double b[] = { 1.0, 2.0, 3.0, 4.0 };
+    double y[4];
+
+    rval = LU_factor(4, row_start, indices, values, &lu);
+    abort_if(rval, "LU_factor failed");
+
+    LU_solve_transposed(&lu, b, y);
+
+    // Should satisfy B^T y = (1, 2, 3, 4)
+    EXPECT_NEAR(y[1] + 2 * y[3], 1.0, E);
+    EXPECT_NEAR(2 * y[0] + 3 * y[2], 2.0, E);
+    EXPECT_NEAR(4 * y[2] + y[3], 3.0, E);
+    EXPECT_NEAR(y[0] - y[3], 4.0, E);
+
+    LU_free(&lu);
+
+CLEANUP:
+    if (rval) FAIL();
+}
+
+TEST(LUTest, singular_test)
+{
+    struct LU lu;
+
+    // B = [ 1  2 ]
+    //     [ 2  4 ]
+    int row_start[] = { 0, 2, 4 };
+    int indices[] = { 0, 1, 0, 1 };
+    double values[] = { 1.0, 2.0, 2.0, 4.0 };
+
+    EXPECT_TRUE(LU_factor(2, row_start, indices, values, &lu) != 0);
+}
@@ -30,6 +30,7 @@
 #include <onerow/stats.hpp>
 #include <onerow/params.hpp>
 #include <cstring>
+#include <omp.h>
 
 using std::cout;
 using std::endl;
@@ -326,7 +327,7 @@ void CplexHelper::read_columns()
 
 	is_integer = new bool[n_cols];
 
-	char ctype[n_cols];
+	char *ctype = new char[n_cols];
 	CPXgetctype(env, lp, ctype, 0, n_cols - 1);
 
 	for (int i = 0; i < n_cols; i++)
@@ -345,10 +346,109 @@ void CplexHelper::read_columns()
 		}
 	}
 
+	delete[] ctype;
+
 	time_printf("Fetched %d rows, %d cols.\n", n_rows, n_cols);
 }
 
 
+/**
+ * Problem data needed to load a copy of the problem into a different
+ * environment.
+ */
+struct ProblemData
+{
+	int n_rows;
+	int n_cols;
+	int objsen;
+	vector<double> obj;
+	vector<double> rhs;
+	vector<double> rngval;
+	vector<char> sense;
+	vector<int> matbeg;
+	vector<int> matcnt;
+	vector<int> matind;
+	vector<double> matval;
+	vector<double> ub;
+	vector<double> lb;
+	vector<int> cstat;
+	vector<int> rstat;
+};
+
+static void read_problem_data(CPXENVptr env, CPXLPptr lp, const int *cstat,
+		const int *rstat, const double *ub, const double *lb, ProblemData &data)
+{
+	int n_rows = data.n_rows = CPXgetnumrows(env, lp);
+	int n_cols = data.n_cols = CPXgetnumcols(env, lp);
+
+	data.objsen = CPXgetobjsen(env, lp);
+	data.obj.resize(n_cols);
+	data.rhs.resize(n_rows);
+	data.rngval.resize(n_rows);
+	data.sense.resize(n_rows);
+	data.matbeg.resize(n_cols);
+	data.matcnt.resize(n_cols);
+	data.ub.assign(ub, ub + n_cols);
+	data.lb.assign(lb, lb + n_cols);
+	data.cstat.assign(cstat, cstat + n_cols);
+	data.rstat.assign(rstat, rstat + n_rows);
+
+	CPXgetobj(env, lp, &data.obj[0], 0, n_cols - 1);
+	CPXgetrhs(env, lp, &data.rhs[0], 0, n_rows - 1);
+	CPXgetrngval(env, lp, &data.rngval[0], 0, n_rows - 1);
+	CPXgetsense(env, lp, &data.sense[0], 0, n_rows - 1);
+
+	int nz, surplus;
+	CPXgetcols(env, lp, &nz, &data.matbeg[0], 0, 0, 0, &surplus, 0, n_cols - 1);
+
+	data.matind.resize(std::max(-surplus, 1));
+	data.matval.resize(std::max(-surplus, 1));
+
+	int status = CPXgetcols(env, lp, &nz, &data.matbeg[0], &data.matind[0],
+			&data.matval[0], -surplus, &surplus, 0, n_cols - 1);
+	if (status) throw std::runtime_error("CPXgetcols");
+
+	for (int j = 0; j < n_cols; j++)
+	{
+		int end = (j + 1 < n_cols ? data.matbeg[j + 1] : nz);
+		data.matcnt[j] = end - data.matbeg[j];
+	}
+}
+
+/**
+ * Loads the problem into a new environment, with the same basis as the
+ * original problem. With an iteration limit of zero, the dual simplex only
+ * factors the given basis, so that the copy keeps the same basic variables.
+ */
+static void load_problem_data(const ProblemData &data, CPXENVptr *env,
+		CPXLPptr *lp)
+{
+	int status;
+
+	*env = CPXopenCPLEX(&status);
+	if (status) throw std::runtime_error("CPXopenCPLEX");
+
+	CPXsetintparam(*env, CPX_PARAM_PREIND, CPX_OFF);
+	CPXsetintparam(*env, CPX_PARAM_NUMERICALEMPHASIS, CPX_ON);
+	CPXsetintparam(*env, CPX_PARAM_THREADS, 1);
+	CPXsetintparam(*env, CPX_PARAM_ITLIM, 0);
+
+	*lp = CPXcreateprob(*env, &status, "tableau");
+	if (status) throw std::runtime_error("CPXcreateprob");
+
+	status = CPXcopylp(*env, *lp, data.n_cols, data.n_rows, data.objsen,
+			&data.obj[0], &data.rhs[0], &data.sense[0], &data.matbeg[0],
+			&data.matcnt[0], &data.matind[0], &data.matval[0], &data.lb[0],
+			&data.ub[0], &data.rngval[0]);
+	if (status) throw std::runtime_error("CPXcopylp");
+
+	status = CPXcopybase(*env, *lp, &data.cstat[0], &data.rstat[0]);
+	if (status) throw std::runtime_error("CPXcopybase");
+
+	status = CPXdualopt(*env, *lp);
+	if (status) throw std::runtime_error("CPXdualopt");
+}
+
 void CplexHelper::read_basis()
 {
 	time_printf("Reading basis...\n");
@@ -379,52 +479,112 @@ void CplexHelper::read_basis()
 	cplex_rows = new CplexRow[n_rows];
 	assert(cplex_rows != 0);
 
+	// The first thread reads the original problem, while the other ones read
+	// their own copy of it. Copies may order the basic variables differently,
+	// so rows are matched through their basic variables.
+	int n_threads = std::max(1, std::min(omp_get_max_threads(), n_rows));
+
+	vector<CPXENVptr> thread_envs(n_threads, env);
+	vector<CPXLPptr> thread_lps(n_threads, lp);
+	vector<vector<int>> positions(n_threads);
+
+	if (n_threads > 1)
+	{
+		ProblemData data;
+		read_problem_data(env, lp, cstat, rstat, ub, lb, data);
+
+		vector<int> thread_head(n_rows);
+
+		for (int t = 1; t < n_threads; t++)
+		{
+			load_problem_data(data, &thread_envs[t], &thread_lps[t]);
+			CPXgetbhead(thread_envs[t], thread_lps[t], &thread_head[0], 0);
+
+			positions[t].assign(n_cols + n_rows, -1);
+			for (int k = 0; k < n_rows; k++)
+			{
+				int var = thread_head[k];
+				positions[t][var >= 0 ? var : n_cols - var - 1] = k;
+			}
+
+			for (int i = 0; i < n_rows; i++)
+			{
+				int var = head[i];
+				if (positions[t][var >= 0 ? var : n_cols - var - 1] < 0)
+					throw std::runtime_error("basis of copy differs");
+			}
+		}
+	}
+
 	eta_reset();
 	eta_count = 0;
 	eta_total = n_rows;
 	std::thread eta(&CplexHelper::eta_print, this);
 
-	for (int i = 0; i < n_rows; i++)
+	#pragma omp parallel num_threads(n_threads)
 	{
-		int nz = 0;
-		double pi[n_cols];
+		int t = omp_get_thread_num();
+		CPXENVptr thread_env = thread_envs[t];
+		CPXLPptr thread_lp = thread_lps[t];
+		const vector<int> &position = positions[t];
 
-		CPXbinvarow(env, lp, i, pi);
+		double *pi = new double[n_cols];
 
-		for (int j = 0; j < n_cols; j++)
+		#pragma omp for schedule(dynamic)
+		for (int i = 0; i < n_rows; i++)
 		{
-			if (fabs(pi[j]) < ZERO_CUTOFF)
-				continue;
+			int nz = 0;
+			int index = i;
 
-			if (cstat[j] == CPX_AT_LOWER)
-				rhs[i] += lb[j] * pi[j];
+			if (!position.empty())
+				index = position[head[i] >= 0 ? head[i] : n_cols - head[i] - 1];
 
-			if (cstat[j] == CPX_AT_UPPER)
-				rhs[i] += ub[j] * pi[j];
+			CPXbinvarow(thread_env, thread_lp, index, pi);
 
-			nz++;
-		}
+			for (int j = 0; j < n_cols; j++)
+			{
+				if (fabs(pi[j]) < ZERO_CUTOFF)
+					continue;
 
-		cplex_rows[i].nz = nz;
-		cplex_rows[i].depth = 0;
-		cplex_rows[i].pi = new double[nz];
-		cplex_rows[i].indices = new int[nz];
-		cplex_rows[i].pi_zero = rhs[i];
-		cplex_rows[i].head = head[i];
+				if (cstat[j] == CPX_AT_LOWER)
+					rhs[i] += lb[j] * pi[j];
 
-		if(fabs(cplex_rows[i].pi_zero) < ZERO_CUTOFF)
-			cplex_rows[i].pi_zero = 0;
+				if (cstat[j] == CPX_AT_UPPER)
+					rhs[i] += ub[j] * pi[j];
 
-		int k = 0;
-		for (int j = 0; j < n_cols; j++)
-		{
-			if (fabs(pi[j]) < ZERO_CUTOFF)
-				continue;
-			cplex_rows[i].pi[k] = pi[j];
-			cplex_rows[i].indices[k++] = j;
+				nz++;
+			}
+
+			cplex_rows[i].nz = nz;
+			cplex_rows[i].depth = 0;
+			cplex_rows[i].pi = new double[nz];
+			cplex_rows[i].indices = new int[nz];
+			cplex_rows[i].pi_zero = rhs[i];
+			cplex_rows[i].head = head[i];
+
+			if(fabs(cplex_rows[i].pi_zero) < ZERO_CUTOFF)
+				cplex_rows[i].pi_zero = 0;
+
+			int k = 0;
+			for (int j = 0; j < n_cols; j++)
+			{
+				if (fabs(pi[j]) < ZERO_CUTOFF)
+					continue;
+				cplex_rows[i].pi[k] = pi[j];
+				cplex_rows[i].indices[k++] = j;
+			}
+
+			#pragma omp atomic
+			eta_count++;
 		}
 
-		eta_count++;
+		delete[] pi;
+	}
+
+	for (int t = 1; t < n_threads; t++)
+	{
+		CPXfreeprob(thread_envs[t], &thread_lps[t]);
+		CPXcloseCPLEX(&thread_envs[t]);
 	}
 
 	eta.join();